@@ -1,296 +1,1991 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <queue>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
-// 内存块头部信息结构（用于追踪和管理）
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <cstdio>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// 对单个函数关闭TSan插桩：无锁空闲栈的投机读按设计就会读到并发写入的
+// 脏值（由版本号CAS兜底），TSan无法建模"读脏值无害"，按惯例只对这一处关闭
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMORY_POOL_NO_TSAN __attribute__((no_sanitize("thread")))
+#else
+#define MEMORY_POOL_NO_TSAN
+#endif
+
+// 调试模式（编译期开关：定义MEMORY_POOL_DEBUG启用，发布构建零开销）。
+// 每个池内块尾部追加16字节调试尾巴（金丝雀+最近一次分配调用点），在
+// 分配/释放边界上校验：金丝雀被毁=越界写，尾巴已是毒值=双重释放（带着
+// 分配调用点一起abort），抽中采样的释放还会给空闲区投毒、重分配时验毒
+//（捕获释放后写）。MEMORY_POOL_DEBUG_SAMPLE_RATE=N时每N次释放做一次
+// 投毒/验毒（默认1=全量），生产环境可用大N长期开启。
+// 不覆盖malloc直通的大块和Arena内部的碰撞指针分配。
+#ifdef MEMORY_POOL_DEBUG
+#ifndef MEMORY_POOL_DEBUG_SAMPLE_RATE
+#define MEMORY_POOL_DEBUG_SAMPLE_RATE 1
+#endif
+#include <cstdio>
+
+// 调试尾巴：紧跟在块的用户区之后（块步长相应加宽，布局由池统一处理）
+struct Memory_Pool_Debug_Trailer {
+    uintptr_t canary; // 存活块=金丝雀魔数^块地址；已投毒的空闲块=毒值魔数^块地址
+    void *alloc_site; // 最近一次分配的调用点（__builtin_return_address，addr2line可解析）
+};
+
+inline constexpr uintptr_t MEMORY_POOL_CANARY_MAGIC = 0x4D50434E41525921ull;
+inline constexpr uintptr_t MEMORY_POOL_POISON_MAGIC = 0x4D50504F49534E21ull;
+inline constexpr unsigned char MEMORY_POOL_POISON_BYTE = 0xDD;
+
+// 调试断言失败：打印块地址和最近一次分配调用点后立即终止（腐坏现场最值钱）
+[[noreturn]] inline void memory_pool_debug_abort(const char *what, void *ptr, void *site) {
+    std::fprintf(stderr, "[Memory_Pool debug] %s: block=%p, last allocated at %p\n", what, ptr,
+                 site);
+    std::fflush(stderr);
+    std::abort();
+}
+
+// 分配调用点（MSVC下暂不采集）
+#if defined(__GNUC__) || defined(__clang__)
+#define MEMORY_POOL_DEBUG_SITE() __builtin_return_address(0)
+#else
+#define MEMORY_POOL_DEBUG_SITE() nullptr
+#endif
+#endif // MEMORY_POOL_DEBUG
+
+// 大块内存头部信息（仅用于malloc直通的大块分配；池内小块不再携带任何头部）
 struct Memory_Block_Header {
-    size_t size;                                            // 实际分配的大小
-    size_t block_size;                                      // 内存池块大小级别
-    bool in_use;                                            // 是否正在使用
-    void *pool_ptr;                                         // 指向所属的内存池（用于释放）
-    std::chrono::steady_clock::time_point last_return_time; // 最后一次归还时间
+    size_t size;  // 实际分配的大小
+    void *raw;    // malloc返回的原始地址（对齐分配时用户指针前有填充）
+    bool charged; // 是否已计入内存预算（全局接管层的malloc兜底块不计费，释放时也不退）
+};
+
+// 池内部代码路径的线程局部重入标记。operator new替换层（Memory_Pool_Global.h）
+// 据此把"池维护自身数据结构时产生的分配"引向malloc兜底，避免递归回池；
+// 池内持有内部互斥锁期间可能分配的区段（slab槽位表、TLS缓存注册、清理）
+// 会临时置位它，杜绝"拿着锁分配→又被路由进池→再抢同一把锁"的自锁。
+inline bool &memory_pool_reentry_flag() {
+    static thread_local bool in_pool = false;
+    return in_pool;
+}
+
+// 作用域内置位重入标记（嵌套时保持原值）
+class Memory_Pool_Reentry_Guard {
+  private:
+    bool saved_;
+
+  public:
+    Memory_Pool_Reentry_Guard() : saved_(memory_pool_reentry_flag()) {
+        memory_pool_reentry_flag() = true;
+    }
+    ~Memory_Pool_Reentry_Guard() { memory_pool_reentry_flag() = saved_; }
+    Memory_Pool_Reentry_Guard(const Memory_Pool_Reentry_Guard &) = delete;
+    Memory_Pool_Reentry_Guard &operator=(const Memory_Pool_Reentry_Guard &) = delete;
+};
+
+class Fixed_Size_Pool;
+
+// 内存预算：已提交字节的relaxed原子计数与硬上限，在分配时即时执行，
+// 而不是等清理周期姗姗来迟地发现超限（容器环境里那就是被OOM杀掉）。
+// slab的提交/归还和malloc直通的大块从同一份预算充放；计费以slab（64KB）
+// 和大块为粒度，单次CAS的开销被slab里的全部块摊薄，无需每线程缓存配额。
+class Memory_Budget {
+  private:
+    std::atomic<size_t> used_ = 0;     // 当前已提交的字节数
+    size_t limit_;                     // 硬上限
+    std::mutex mutex_;                 // 阻塞等待的互斥锁
+    std::condition_variable cv_;       // 预算释放时唤醒等待者
+    std::atomic<size_t> waiters_ = 0;  // 当前阻塞等待的线程数（无等待者时释放路径不加锁）
+    std::atomic<bool> shutdown_ = false; // 池关闭标记（唤醒所有等待者退出）
+
+  public:
+    explicit Memory_Budget(size_t limit) : limit_(limit) {}
+
+    // 尝试计入bytes字节，超限时不改动计数并返回false
+    bool try_charge(size_t bytes) {
+        size_t used = used_.load(std::memory_order_relaxed);
+        do {
+            if (used + bytes > limit_) {
+                return false;
+            }
+        } while (!used_.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+        return true;
+    }
+
+    // 释放bytes字节的配额，有等待者时顺带唤醒
+    void uncharge(size_t bytes) {
+        used_.fetch_sub(bytes, std::memory_order_relaxed);
+        if (waiters_.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    // 阻塞等待别处释放配额（带超时轮询，避免错过唤醒），返回是否值得重试
+    bool wait_for_room() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_release);
+        cv_.wait_for(lock, std::chrono::milliseconds(100),
+                     [this] { return shutdown_.load(std::memory_order_relaxed); });
+        waiters_.fetch_sub(1, std::memory_order_release);
+        return !shutdown_.load(std::memory_order_relaxed);
+    }
+
+    // 关闭预算：唤醒所有阻塞的分配线程让它们失败返回
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_.store(true, std::memory_order_relaxed);
+        cv_.notify_all();
+    }
+
+    size_t used() const { return used_.load(std::memory_order_relaxed); }
+    size_t limit() const { return limit_; }
+};
+
+// slab头部信息结构（位于每个slab的起始处，承载整个slab的元数据）
+// 块指针用64KB对齐掩码即可反推出所属slab，因此池内小块无需携带头部。
+// slab头部之后紧跟in_use位图，再往后是按块大小切分的数据区。
+struct Slab_Header {
+    Fixed_Size_Pool *pool;                // 所属内存池
+    Slab_Header *next;                    // slab单向链表
+    size_t block_count;                   // slab中的块总数
+    std::atomic<size_t> free_in_list;     // 当前位于全局空闲链表中的块数
+    std::atomic<int64_t> last_return_ns;  // slab内最后一次归还时间（steady_clock纳秒数）
+    bool reclaiming = false;              // 清理过程中的标记位（仅在持锁时使用）
+    size_t reclaim_seen = 0;              // 清理清点时实际在手的块数（仅在持锁时使用）
+};
+
+// 空闲slab归还物理页的方式（set_slab_release_mode设置）
+enum class Slab_Release_Mode {
+    Decommit, // 解除提交（PROT_NONE重映射/MEM_DECOMMIT）：物理页立即归还，复用时缺页+清零
+    Advise,   // 通告丢弃（MADV_FREE，退化MADV_DONTNEED/MEM_RESET）：映射保持可写，
+              // 物理页由操作系统在内存压力下惰性回收；低谷后回暖时尚未被回收的页
+              // 无需缺页即可复用，适合日夜潮汐型负载
+};
+
+// slab地址区域：构造时一次性保留一整段连续虚拟地址空间，slab按需提交物理内存。
+// 所有slab都落在这段区域内，因此"指针是否来自内存池"只需一次范围比较。
+// 一个slab可以由多个连续的64KB单元组成（span），供中/大块级别使用；
+// 区域维护一张"单元→slab头部"的平面映射表，任意块指针O(1)即可找到所属slab。
+class Slab_Region {
+  public:
+    static constexpr size_t SLAB_SIZE = 64 * 1024; // slab单元大小（64KB，对齐到该边界）
+
+  private:
+    char *base_ = nullptr;           // 对齐到SLAB_SIZE的区域起始地址
+    size_t capacity_ = 0;            // 区域总容量（SLAB_SIZE的倍数）
+    size_t next_offset_ = 0;         // 尚未切分出去的高水位偏移
+    std::unordered_map<size_t, std::vector<void *>> free_slots_; // 按单元数分组的可复用槽位
+    std::mutex mutex_;               // 保护槽位分配（slab级操作，本身就是慢速路径）
+    std::unique_ptr<std::atomic<Slab_Header *>[]> unit_map_; // 单元→slab头部映射表
+    Memory_Budget *budget_ = nullptr; // 内存预算（提交时计费，归还时释放配额）
+    std::atomic<Slab_Release_Mode> release_mode_{Slab_Release_Mode::Decommit}; // 归还方式
+    bool recycled_ever_advised_ = false; // 曾以Advise方式归还过槽位（mutex_保护）：
+                                         // 此后复用的槽位可能带脏页，不得再假设为零
+#if !defined(_WIN32)
+    void *raw_base_ = nullptr; // mmap返回的原始地址（用于munmap）
+    size_t raw_size_ = 0;      // mmap的原始长度
+#endif
+
+  public:
+    explicit Slab_Region(size_t capacity, Memory_Budget *budget = nullptr,
+                         Slab_Release_Mode release_mode = Slab_Release_Mode::Decommit)
+        : budget_(budget), release_mode_(release_mode) {
+        capacity_ = (capacity + SLAB_SIZE - 1) & ~(SLAB_SIZE - 1);
+        // 值初始化保证映射表清零（空项表示该单元尚未归属任何slab）
+        unit_map_ = std::make_unique<std::atomic<Slab_Header *>[]>(capacity_ / SLAB_SIZE);
+#if defined(_WIN32)
+        // Windows下VirtualAlloc的保留粒度就是64KB，天然对齐
+        base_ = static_cast<char *>(
+            VirtualAlloc(nullptr, capacity_, MEM_RESERVE, PAGE_NOACCESS));
+        if (!base_) {
+            throw std::runtime_error("Slab region reservation failed");
+        }
+#else
+        // 多保留一个SLAB_SIZE，以便把起始地址向上对齐到64KB边界
+        raw_size_ = capacity_ + SLAB_SIZE;
+        void *addr = mmap(nullptr, raw_size_, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Slab region reservation failed");
+        }
+        raw_base_ = addr;
+        uintptr_t aligned =
+            (reinterpret_cast<uintptr_t>(addr) + SLAB_SIZE - 1) & ~(uintptr_t(SLAB_SIZE) - 1);
+        base_ = reinterpret_cast<char *>(aligned);
+#endif
+    }
+
+    ~Slab_Region() {
+#if defined(_WIN32)
+        VirtualFree(base_, 0, MEM_RELEASE);
+#else
+        munmap(raw_base_, raw_size_);
+#endif
+    }
+
+    // 禁止拷贝和移动（区域地址被各slab指针依赖）
+    Slab_Region(const Slab_Region &) = delete;
+    Slab_Region &operator=(const Slab_Region &) = delete;
+    Slab_Region(Slab_Region &&) = delete;
+    Slab_Region &operator=(Slab_Region &&) = delete;
+
+    // 取得一个已提交物理内存的slab（units个连续的64KB单元），区域耗尽时返回nullptr
+    // zeroed非空时带出数据是否保证为零：Advise方式归还过的槽位复用时可能带脏页
+    void *acquire_slab(size_t units = 1, bool *zeroed = nullptr) {
+        Memory_Pool_Reentry_Guard reentry; // 槽位表的内部分配不得路由回池
+        size_t bytes = units * SLAB_SIZE;
+        void *slot = nullptr;
+        if (zeroed) {
+            *zeroed = true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &slots = free_slots_[units];
+            if (!slots.empty()) {
+                slot = slots.back();
+                slots.pop_back();
+                if (zeroed && recycled_ever_advised_) {
+                    *zeroed = false;
+                }
+            } else if (next_offset_ + bytes <= capacity_) {
+                slot = base_ + next_offset_;
+                next_offset_ += bytes;
+            } else {
+                return nullptr; // 虚拟地址区域耗尽
+            }
+        }
+
+        // 提交前先过预算：超限时把槽位退回，分配立即失败（上层按策略处理）
+        if (budget_ && !budget_->try_charge(bytes)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_[units].push_back(slot);
+            return nullptr;
+        }
+
+        // 提交物理内存（新提交的页由操作系统保证清零）
+#if defined(_WIN32)
+        if (!VirtualAlloc(slot, bytes, MEM_COMMIT, PAGE_READWRITE)) {
+            if (budget_) {
+                budget_->uncharge(bytes);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_[units].push_back(slot);
+            return nullptr;
+        }
+#else
+        if (mprotect(slot, bytes, PROT_READ | PROT_WRITE) != 0) {
+            if (budget_) {
+                budget_->uncharge(bytes);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_[units].push_back(slot);
+            return nullptr;
+        }
+#endif
+        return slot;
+    }
+
+    // 登记slab占用的所有单元到映射表（必须在块进入空闲栈之前调用）
+    void map_slab(void *slab, size_t units, Slab_Header *header) {
+        size_t first = (static_cast<char *>(slab) - base_) / SLAB_SIZE;
+        for (size_t i = 0; i < units; ++i) {
+            unit_map_[first + i].store(header, std::memory_order_release);
+        }
+    }
+
+    // 归还一个slab：清除映射、释放物理内存，槽位留待复用（虚拟地址保留）
+    void release_slab(void *slab, size_t units = 1) {
+        Memory_Pool_Reentry_Guard reentry; // 槽位表的内部分配不得路由回池
+        size_t bytes = units * SLAB_SIZE;
+        size_t first = (static_cast<char *>(slab) - base_) / SLAB_SIZE;
+        for (size_t i = 0; i < units; ++i) {
+            unit_map_[first + i].store(nullptr, std::memory_order_release);
+        }
+        bool advised = release_mode_.load(std::memory_order_relaxed) == Slab_Release_Mode::Advise;
+#if defined(_WIN32)
+        if (advised) {
+            // MEM_RESET：保持提交状态、通告内容可丢弃（MADV_FREE在Windows下的等价物）
+            VirtualAlloc(slab, bytes, MEM_RESET, PAGE_READWRITE);
+        } else {
+            VirtualFree(slab, bytes, MEM_DECOMMIT);
+        }
+#else
+        if (advised) {
+            // 映射保持可读写，物理页交由操作系统按内存压力惰性回收；
+            // 回暖时尚未被回收的页直接复用，既无缺页也无清零开销
+#if defined(MADV_FREE)
+            madvise(slab, bytes, MADV_FREE);
+#else
+            madvise(slab, bytes, MADV_DONTNEED);
+#endif
+        } else {
+            // 用一个全新的PROT_NONE映射覆盖原区间，物理页立即归还给操作系统
+            mmap(slab, bytes, PROT_NONE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        }
+#endif
+        // 预算按归还即释放配额记账：Advise方式下物理页可能暂留，但已随时可被回收
+        if (budget_) {
+            budget_->uncharge(bytes);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (advised) {
+            recycled_ever_advised_ = true;
+        }
+        free_slots_[units].push_back(slab);
+    }
+
+    // 切换空闲slab的归还方式（随时可调，已按旧方式归还的槽位复用时按保守路径处理）
+    void set_release_mode(Slab_Release_Mode mode) {
+        release_mode_.store(mode, std::memory_order_relaxed);
+    }
+
+    // 从任意落在区域内的指针找到所属slab头部（O(1)查映射表，未登记的单元返回nullptr）
+    Slab_Header *slab_at(const void *ptr) const {
+        size_t index = (static_cast<const char *>(ptr) - base_) / SLAB_SIZE;
+        return unit_map_[index].load(std::memory_order_acquire);
+    }
+
+    // 从映射表摘除slab占用的所有单元（退役slab时调用，物理归还可以延后）
+    void unmap_slab(void *slab, size_t units) {
+        size_t first = (static_cast<char *>(slab) - base_) / SLAB_SIZE;
+        for (size_t i = 0; i < units; ++i) {
+            unit_map_[first + i].store(nullptr, std::memory_order_release);
+        }
+    }
+
+    // 判断指针是否落在本区域内（即是否是池内的块）
+    bool contains(const void *ptr) const {
+        const char *p = static_cast<const char *>(ptr);
+        return p >= base_ && p < base_ + capacity_;
+    }
+};
+
+// 基于线程静默期（QSBR）的纪元回收器：让后台清理和无锁快速路径安全共存。
+// 无锁空闲栈的pop会先投机读取块内的next指针再CAS，读到的可能是已被
+// 清理线程摘除的slab里的块；若此时物理页已归还，投机读就是野指针访问。
+// 解法：退役的slab先进灵薄链（limbo），只有当所有使用过池的线程都在
+// 退役之后通告过一次静默点（每次allocate/deallocate入口处一次普通存储），
+// 物理页才真正归还——宽限期内的投机读访问的仍是有效映射，CAS会让它失败重试。
+// 线程长期不再调用池接口会推迟（但不阻止其他slab的）物理归还，线程退出时
+// 记录自动注销；这是QSBR的标准契约：静默通告搭便车在既有调用流量上。
+class Epoch_Reclaimer {
+  public:
+    // 每线程一条记录：热路径只在自己的记录上做一次存储，无任何共享写竞争
+    struct Thread_Record {
+        Epoch_Reclaimer *owner = nullptr;        // 所属回收器（注册锁保护下修改，先亡时置空）
+        std::atomic<uint64_t> seen{0};           // 最近一次通告静默点时观察到的全局纪元
+        Thread_Record *next_for_thread = nullptr; // 同线程在各回收器上的记录链（侵入式）
+    };
+
+  private:
+    // 灵薄链表项：等待宽限期结束的退役slab
+    struct Limbo_Slab {
+        void *slab;     // slab起始地址
+        size_t units;   // 占用的64KB单元数
+        uint64_t epoch; // 退役时的纪元（所有在线线程通告超过它即可归还）
+    };
+
+    // 每线程的记录注册表：线程退出时把仍有归属的记录从回收器注销并释放。
+    // 记录链是侵入式的（经next_for_thread串联）：注册表本身不做任何堆分配，
+    // 析构体内没有任何会被路由回池的释放（全局new/delete接管下这点是硬性要求）
+    struct Thread_Record_Registry {
+        Thread_Record *head = nullptr;            // 本线程在各回收器上的记录链
+        Epoch_Reclaimer *last_owner = nullptr;    // 上次命中的回收器（单池程序的快速路径）
+        Thread_Record *last_record = nullptr;     // 上次命中的记录
+
+        ~Thread_Record_Registry() {
+            Memory_Pool_Reentry_Guard reentry; // 记录在重入态下分配，对称地在重入态下释放
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            while (head) {
+                Thread_Record *next = head->next_for_thread;
+                if (head->owner) {
+                    head->owner->remove_record(head);
+                }
+                delete head;
+                head = next;
+            }
+            last_owner = nullptr;
+            last_record = nullptr;
+        }
+    };
+
+    Slab_Region *region_;                  // 物理归还的目标区域（由Memory_Pool持有）
+    std::atomic<uint64_t> epoch_{1};       // 全局纪元（每次退役后递增）
+    std::mutex limbo_mutex_;               // 保护灵薄链（只在清理慢速路径上竞争）
+    std::vector<Limbo_Slab> limbo_;        // 等待宽限期结束的slab
+    std::vector<Thread_Record *> records_; // 在线线程记录（注册锁保护）
+
+    // 保护"回收器⇄线程记录"注册关系的全局互斥锁（只在生命周期边界使用）
+    static std::mutex &registry_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // 从本回收器注销一条记录（调用方必须持有registry_mutex）
+    void remove_record(Thread_Record *record) {
+        records_.erase(std::remove(records_.begin(), records_.end(), record), records_.end());
+    }
+
+    // 取得当前线程在本回收器上的记录（首次使用时创建并在两边注册）。
+    // 旧回收器析构时会把记录的owner置空，新回收器可能恰好复用旧的地址，
+    // 因此地址命中后还要验证归属仍然成立——否则会一直通告到一条flush
+    // 永远不读的孤儿记录上，宽限期对本线程形同虚设（同TLS缓存注册表的教训）
+    Thread_Record *record_for_thread() {
+        static thread_local Thread_Record_Registry registry;
+        if (registry.last_owner == this && registry.last_record->owner == this) {
+            return registry.last_record;
+        }
+        for (Thread_Record *record = registry.head; record; record = record->next_for_thread) {
+            if (record->owner == this) {
+                registry.last_owner = this;
+                registry.last_record = record;
+                return record;
+            }
+        }
+
+        // 记录对象本身的分配不得路由回池（全局接管下new会递归）
+        Memory_Pool_Reentry_Guard reentry;
+        auto *record = new Thread_Record();
+        record->owner = this;
+        record->seen.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            records_.push_back(record);
+        }
+        record->next_for_thread = registry.head;
+        registry.head = record;
+        registry.last_owner = this;
+        registry.last_record = record;
+        return record;
+    }
+
+    // 归还纪元早于min_seen的灵薄slab（系统调用在灵薄锁外进行）
+    size_t flush_until(uint64_t min_seen) {
+        Memory_Pool_Reentry_Guard reentry; // 向量整理的内部分配不得路由回池
+        std::vector<Limbo_Slab> ready;
+        {
+            std::lock_guard<std::mutex> lock(limbo_mutex_);
+            auto split = std::partition(limbo_.begin(), limbo_.end(),
+                                        [&](const Limbo_Slab &s) { return s.epoch >= min_seen; });
+            ready.assign(split, limbo_.end());
+            limbo_.erase(split, limbo_.end());
+        }
+        for (const Limbo_Slab &slab : ready) {
+            region_->release_slab(slab.slab, slab.units);
+        }
+        return ready.size();
+    }
+
+  public:
+    explicit Epoch_Reclaimer(Slab_Region *region) : region_(region) {}
+
+    ~Epoch_Reclaimer() {
+        // 析构契约与池一致：外部已停止并发使用，灵薄链可无条件归还
+        flush_until(UINT64_MAX);
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        for (Thread_Record *record : records_) {
+            record->owner = nullptr;
+        }
+        records_.clear();
+    }
+
+    Epoch_Reclaimer(const Epoch_Reclaimer &) = delete;
+    Epoch_Reclaimer &operator=(const Epoch_Reclaimer &) = delete;
+
+    // 通告静默点：调用线程此刻不持有任何指向池内空闲块的裸指针。
+    // acquire读纪元：读到新纪元就必然看到退役前的空闲栈过滤和映射表清除，
+    // 之后不可能再捞到退役slab里的块；release写seen：回收方看到通告时，
+    // 通告之前的一切投机读都已完成。x86上两者都编译成普通mov，
+    // 热路径的代价就是一次普通存储。
+    void announce() {
+        Thread_Record *record = record_for_thread();
+        record->seen.store(epoch_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // 退役一个slab：调用方保证它已对所有无锁路径不可达（空闲栈已过滤、
+    // 收件箱已清点）；这里摘除单元映射、挂入灵薄链并推进纪元
+    void retire(void *slab, size_t units) {
+        region_->unmap_slab(slab, units);
+        std::lock_guard<std::mutex> lock(limbo_mutex_);
+        limbo_.push_back({slab, units, epoch_.load(std::memory_order_relaxed)});
+        epoch_.fetch_add(1, std::memory_order_release);
+    }
+
+    // 归还已度过宽限期的灵薄slab：所有在线线程的通告纪元都超过了退役纪元。
+    // 返回归还数量（清理周期调用；没有在线线程时全部可归还）
+    size_t flush() {
+        uint64_t min_seen = epoch_.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            for (Thread_Record *record : records_) {
+                min_seen = std::min(min_seen, record->seen.load(std::memory_order_acquire));
+            }
+        }
+        return flush_until(min_seen);
+    }
+
+    // 灵薄链中是否还有待归还的slab（清理线程据此决定是否继续短间隔推进）
+    bool has_pending() {
+        std::lock_guard<std::mutex> lock(limbo_mutex_);
+        return !limbo_.empty();
+    }
 };
 
-// 单级内存池（管理特定大小的内存块）
+// 单级内存池（管理特定大小的内存块，从Slab_Region取64KB对齐的slab切分）
+// 池内小块不携带任何头部：所属slab由指针的64KB对齐掩码推出，块大小、所属池
+// 和in_use状态都记录在slab头部（含位图）中，8字节的分配只占8字节。
+// 全局空闲链表采用无锁Treiber栈：空闲块本身的前8字节存放next指针，
+// 头指针的高16位打包一个版本号（x86-64用户态指针只占低48位）用于规避ABA问题。
+// 互斥锁只保护slab的获取与归还这条慢速路径。
 class Fixed_Size_Pool {
   private:
-    size_t block_size_;                       // 块大小
+    static constexpr unsigned TAG_SHIFT = 48;                          // 版本号所在的位偏移
+    static constexpr uintptr_t PTR_MASK = (uintptr_t(1) << TAG_SHIFT) - 1; // 指针部分的掩码
+
+    size_t block_size_;                       // 块大小（用户可见的级别大小）
+    size_t stride_;                           // 块步长（调试模式下=块大小+调试尾巴，否则相等）
     size_t alignment_;                        // 对齐大小
-    std::list<void *> free_blocks_;           // 空闲块链表
-    std::mutex mutex_;                        // 保护该池的互斥锁
+    size_t natural_alignment_;                // 本级别块的自然对齐（数据区布局保证）
+    size_t span_units_;                       // 每个slab占用的64KB单元数（中/大块级别>1）
+    size_t bitmap_words_;                     // 每张位图的64位字数
+    size_t data_offset_;                      // slab内数据区的起始偏移（头部+位图之后）
+    size_t blocks_per_slab_;                  // 每个slab承载的块数
+    Slab_Region *region_;                     // slab地址区域（由Memory_Pool持有）
+    Epoch_Reclaimer *reclaimer_;              // 纪元回收器（为空时退役slab立即归还）
+    std::atomic<uintptr_t> free_head_ = 0;    // 无锁空闲栈的头（指针+版本号打包）
+    // 远程释放收件箱：释放路径只在这条独立缓存行上CAS，不再与分配路径
+    // 争抢free_head_；分配方在空闲栈耗尽时整链摘下并入空闲栈。
+    // 收件箱只有push和整体摘除两种操作、从不单个弹出，因此无ABA问题，
+    // 存裸指针即可（不打包版本号）。
+    alignas(64) std::atomic<void *> remote_head_{nullptr};
+    Slab_Header *slabs_ = nullptr;            // slab链表头
+    std::mutex mutex_;                        // 保护slab获取/归还的互斥锁
     std::atomic<size_t> current_used_ = 0;    // 当前使用中的块数
     std::atomic<size_t> current_free_ = 0;    // 当前空闲的块数
     std::atomic<size_t> total_allocated_ = 0; // 总分配块数
+    std::atomic<size_t> alloc_count_ = 0;     // 累计从本池分配的次数（含批量补充）
+    std::atomic<size_t> free_count_ = 0;      // 累计归还到本池的次数
+    std::atomic<size_t> slow_path_count_ = 0; // 空闲栈耗尽、进入加锁slab路径的次数
+
+    // 打包指针和版本号
+    static uintptr_t pack_head(void *ptr, uintptr_t tag) {
+        return (tag << TAG_SHIFT) | (reinterpret_cast<uintptr_t>(ptr) & PTR_MASK);
+    }
+
+    // 投机读取块内的next指针：块可能刚被别的线程弹走并写入了新内容，读到
+    // 脏值由pop_free的版本号CAS兜底（必然失败重试）；块所在的slab可能刚被
+    // 清理线程摘除，此时它在纪元回收器的灵薄链中、映射仍然有效（宽限期保证）。
+    // "与新主人的写并发地读"正是设计本身，对这一条读取关闭TSan插桩
+    MEMORY_POOL_NO_TSAN static void *speculative_next(void *block) {
+        return *static_cast<void **>(block);
+    }
+
+    // 无锁弹出一个空闲块，栈空时返回nullptr（next的投机读见speculative_next）
+    void *pop_free() {
+        uintptr_t head = free_head_.load(std::memory_order_acquire);
+        while (true) {
+            void *ptr = reinterpret_cast<void *>(head & PTR_MASK);
+            if (!ptr) {
+                return nullptr;
+            }
+            void *next = speculative_next(ptr);
+            uintptr_t new_head = pack_head(next, (head >> TAG_SHIFT) + 1);
+            if (free_head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                return ptr;
+            }
+        }
+    }
+
+    // 无锁压入一条块链（first..last通过块内next指针串联）
+    void push_free_chain(void *first, void *last) {
+        uintptr_t head = free_head_.load(std::memory_order_relaxed);
+        uintptr_t new_head;
+        do {
+            *static_cast<void **>(last) = reinterpret_cast<void *>(head & PTR_MASK);
+            new_head = pack_head(first, (head >> TAG_SHIFT) + 1);
+        } while (!free_head_.compare_exchange_weak(head, new_head, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+
+    // 把一条块链压入远程释放收件箱（first..last通过块内next指针串联）
+    void push_remote_chain(void *first, void *last) {
+        void *head = remote_head_.load(std::memory_order_relaxed);
+        do {
+            *static_cast<void **>(last) = head;
+        } while (!remote_head_.compare_exchange_weak(head, first, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+    }
+
+    // 整体摘下收件箱并并入空闲栈，返回是否摘到了块。找链尾的遍历由单个
+    // 摘除者完成，代价被整批释放方省下的free_head_竞争摊薄。
+    bool drain_remote() {
+        void *chain = remote_head_.exchange(nullptr, std::memory_order_acquire);
+        if (!chain) {
+            return false;
+        }
+        void *last = chain;
+        while (*static_cast<void **>(last)) {
+            last = *static_cast<void **>(last);
+        }
+        push_free_chain(chain, last);
+        return true;
+    }
+
+    // 摘下整条空闲栈（清理时使用，之后其他线程看到的是空栈）
+    void *detach_all() {
+        uintptr_t head = free_head_.load(std::memory_order_acquire);
+        uintptr_t new_head;
+        do {
+            new_head = pack_head(nullptr, (head >> TAG_SHIFT) + 1);
+        } while (!free_head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+        return reinterpret_cast<void *>(head & PTR_MASK);
+    }
+
+    // slab内的in_use位图（紧跟在slab头部之后）
+    static std::atomic<uint64_t> *bitmap_of(Slab_Header *slab) {
+        return reinterpret_cast<std::atomic<uint64_t> *>(reinterpret_cast<char *>(slab) +
+                                                         sizeof(Slab_Header));
+    }
+
+    // slab内的已知零位图（紧跟在in_use位图之后）：置位表示块内容为零，
+    // 只有空闲链表的next字（块首8字节）可能是脏的
+    std::atomic<uint64_t> *zero_bitmap_of(Slab_Header *slab) const {
+        return bitmap_of(slab) + bitmap_words_;
+    }
+
+    // 块在slab内的下标（调用方保证ptr落在本池的slab数据区内）
+    size_t block_index(Slab_Header *slab, void *ptr) const {
+        return (static_cast<char *>(ptr) - (reinterpret_cast<char *>(slab) + data_offset_)) /
+               stride_;
+    }
+
+    // 在位图中标记块为使用中
+    void mark_in_use(Slab_Header *slab, void *ptr) {
+        size_t index = block_index(slab, ptr);
+        bitmap_of(slab)[index / 64].fetch_or(uint64_t(1) << (index % 64),
+                                             std::memory_order_relaxed);
+    }
+
+    // 在位图中标记块为空闲，返回之前是否处于使用中（false表示双重释放）
+    bool mark_free(Slab_Header *slab, void *ptr) {
+        size_t index = block_index(slab, ptr);
+        uint64_t bit = uint64_t(1) << (index % 64);
+        uint64_t old = bitmap_of(slab)[index / 64].fetch_and(~bit, std::memory_order_relaxed);
+        return (old & bit) != 0;
+    }
+
+#ifdef MEMORY_POOL_DEBUG
+    // 调试模式下位图校验失败不再静默吞掉：落在块边界上的指针带着可信的
+    // 调试尾巴（报最近一次分配调用点），否则按野指针释放处理
+    [[noreturn]] void debug_abort_on_bad_free(Slab_Header *slab, void *ptr) {
+        if (is_valid_block(slab, ptr)) {
+            auto *trailer = reinterpret_cast<Memory_Pool_Debug_Trailer *>(
+                static_cast<char *>(ptr) + block_size_);
+            memory_pool_debug_abort("double free (in_use bitmap already clear)", ptr,
+                                    trailer->alloc_site);
+        }
+        memory_pool_debug_abort("invalid free (pointer not on a block boundary of this pool)",
+                                ptr, nullptr);
+    }
+#endif
+
+    // 取出并清除块的已知零标记，返回之前是否已知为零。离开空闲栈的块
+    // 随后都会被使用方弄脏，因此在弹出时统一消费该标记。
+    bool consume_zero_state(Slab_Header *slab, void *ptr) {
+        size_t index = block_index(slab, ptr);
+        uint64_t bit = uint64_t(1) << (index % 64);
+        uint64_t old = zero_bitmap_of(slab)[index / 64].fetch_and(~bit, std::memory_order_relaxed);
+        return (old & bit) != 0;
+    }
+
+    // 查询块的已知零标记（预零化时跳过已经是零的块）
+    bool test_zero_state(Slab_Header *slab, void *ptr) const {
+        size_t index = block_index(slab, ptr);
+        return (zero_bitmap_of(slab)[index / 64].load(std::memory_order_relaxed) >>
+                (index % 64)) & 1;
+    }
+
+    // 标记块为已知零（调用方必须独占持有该块，例如摘下的空闲链）
+    void set_zero_state(Slab_Header *slab, void *ptr) {
+        size_t index = block_index(slab, ptr);
+        zero_bitmap_of(slab)[index / 64].fetch_or(uint64_t(1) << (index % 64),
+                                                  std::memory_order_relaxed);
+    }
+
+    // 校验待释放指针：必须落在本池的slab数据区内且对齐到块边界
+    bool is_valid_block(Slab_Header *slab, void *ptr) const {
+        if (slab->pool != this) {
+            return false;
+        }
+        ptrdiff_t offset =
+            static_cast<char *>(ptr) - (reinterpret_cast<char *>(slab) + data_offset_);
+        return offset >= 0 && static_cast<size_t>(offset) % stride_ == 0 &&
+               static_cast<size_t>(offset) / stride_ < slab->block_count;
+    }
+
+    // 从区域取一个新slab并把其中的块整链压入空闲栈（调用时必须持有mutex_）
+    bool allocate_slab() {
+        bool data_zeroed = true;
+        void *raw_ptr = region_->acquire_slab(span_units_, &data_zeroed);
+        if (!raw_ptr) {
+            return false;
+        }
+
+        int64_t now_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+        Slab_Header *slab =
+            new (raw_ptr) Slab_Header{this, slabs_, blocks_per_slab_, {blocks_per_slab_}, {now_ns}};
+        slabs_ = slab;
+
+        // 位图清零（新提交的slab页本身是零页，这里显式清一次以不依赖平台行为）
+        std::memset(reinterpret_cast<char *>(slab) + sizeof(Slab_Header), 0,
+                    data_offset_ - sizeof(Slab_Header));
+        // 数据区来自零页时整张已知零位图置位，allocate_zeroed可跳过memset；
+        // Advise方式回收过的槽位可能带脏页，此时位图保持全零（上面已清）
+        if (data_zeroed) {
+            std::memset(reinterpret_cast<char *>(slab) + sizeof(Slab_Header) + bitmap_words_ * 8,
+                        0xFF, bitmap_words_ * 8);
+        }
+
+        // 在释放任何块给其他线程之前登记单元映射，保证slab_of随时可用
+        region_->map_slab(raw_ptr, span_units_, slab);
+
+        // 把数据区切分成块并在块内串成next链
+        char *cursor = static_cast<char *>(raw_ptr) + data_offset_;
+        void *first = cursor;
+        void *prev = nullptr;
+        for (size_t i = 0; i < blocks_per_slab_; ++i) {
+            if (prev) {
+                *static_cast<void **>(prev) = cursor;
+            }
+            prev = cursor;
+            cursor += stride_;
+        }
+
+        current_free_ += blocks_per_slab_;
+        total_allocated_ += blocks_per_slab_;
+        push_free_chain(first, prev);
+        return true;
+    }
+
+// 清理的公共骨架：挑选至多max_slabs个满足谓词且完全空闲的slab，
+    // 持锁阶段只做标记、清点、空闲栈过滤和链表摘除；把页面归还给操作系统
+    // （或交给纪元回收器等待宽限期）在锁外进行，避免清理期间阻塞分配慢速路径。
+    // 返回本次释放的slab数量（等于max_slabs时说明可能还有积压）。
+    template <typename Pred> size_t release_slabs_if(Pred &&should_release, size_t max_slabs) {
+        Slab_Header *victims = nullptr; // 已摘除的受害slab链（复用next字段）
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // 1. 限量标记候选slab（free_in_list此时只是线索：释放路径先计数
+            // 后入收件箱，计数到位不代表块已经可见，真正的裁决在第3步清点）
+            size_t marked = 0;
+            for (Slab_Header *slab = slabs_; slab; slab = slab->next) {
+                slab->reclaiming = marked < max_slabs &&
+                                   slab->free_in_list.load(std::memory_order_relaxed) ==
+                                       slab->block_count &&
+                                   should_release(slab);
+                slab->reclaim_seen = 0;
+                if (slab->reclaiming) {
+                    marked++;
+                }
+            }
+            if (marked == 0) {
+                return 0;
+            }
+
+            // 2. 把远程释放收件箱并入空闲栈后整体摘下：候选slab的块要么
+            // 已经在手，要么还在某个释放线程的路上——后者会让清点凑不齐
+            drain_remote();
+            void *chain = detach_all();
+
+            // 3. 清点：统计每个候选slab有多少块真的握在手里；凑不齐整张slab
+            // 的候选本轮放过——它还有块在飞行中，退役会让收件箱留下悬空指针
+            for (void *cursor = chain; cursor; cursor = *static_cast<void **>(cursor)) {
+                Slab_Header *slab = slab_of(cursor);
+                if (slab->reclaiming) {
+                    slab->reclaim_seen++;
+                }
+            }
+            for (Slab_Header *slab = slabs_; slab; slab = slab->next) {
+                if (slab->reclaiming && slab->reclaim_seen != slab->block_count) {
+                    slab->reclaiming = false;
+                }
+            }
+
+            // 4. 过滤空闲栈：受害slab的块全部拿掉，其余原序保留
+            void *keep_first = nullptr;
+            void *keep_last = nullptr;
+            while (chain) {
+                void *next = *static_cast<void **>(chain);
+                Slab_Header *slab = slab_of(chain);
+                if (!slab->reclaiming) {
+                    if (!keep_first) {
+                        keep_first = chain;
+                    } else {
+                        *static_cast<void **>(keep_last) = chain;
+                    }
+                    keep_last = chain;
+                }
+                chain = next;
+            }
+
+            // 5. 把受害slab从slab链表摘到本地链上并更新计数
+            Slab_Header **link = &slabs_;
+            while (*link) {
+                Slab_Header *slab = *link;
+                if (slab->reclaiming) {
+                    *link = slab->next;
+                    slab->next = victims;
+                    victims = slab;
+                    current_free_ -= slab->block_count;
+                    total_allocated_ -= slab->block_count;
+                } else {
+                    link = &slab->next;
+                }
+            }
+
+            // 6. 把保留的块放回空闲栈
+            if (keep_first) {
+                push_free_chain(keep_first, keep_last);
+            }
+        }
+
+        // 7. 锁外处理受害slab：有纪元回收器时退役进灵薄链（宽限期过后才归还
+        // 物理页，并发路径上的投机读始终访问有效映射），否则立即归还
+        size_t released_slabs = 0;
+        while (victims) {
+            Slab_Header *next = victims->next;
+            if (reclaimer_) {
+                reclaimer_->retire(victims, span_units_);
+            } else {
+                region_->release_slab(victims, span_units_);
+            }
+            victims = next;
+            released_slabs++;
+        }
+        return released_slabs;
+    }
+
   public:
-    Fixed_Size_Pool(size_t block_size, size_t alignment = 8)
-        : block_size_(block_size), alignment_(alignment), mutex_() {
-        // 确保块大小是对齐大小的倍数
+    Fixed_Size_Pool(size_t block_size, Slab_Region *region, size_t alignment = 8,
+                    Epoch_Reclaimer *reclaimer = nullptr)
+        : block_size_(block_size), alignment_(alignment), region_(region),
+          reclaimer_(reclaimer), mutex_() {
+        // 确保块大小是对齐大小的倍数，且至少能容纳空闲栈的next指针
         block_size_ = (block_size_ + alignment_ - 1) & ~(alignment_ - 1);
+        if (block_size_ < sizeof(void *)) {
+            block_size_ = sizeof(void *);
+        }
+
+        // 块步长：调试模式下在用户区之后追加调试尾巴（块大小已按对齐取整，
+        // 尾巴自身16字节，步长仍保持对齐）
+        stride_ = block_size_;
+#ifdef MEMORY_POOL_DEBUG
+        stride_ += sizeof(Memory_Pool_Debug_Trailer);
+#endif
+
+        // 大块级别用多单元span承载，保证每个slab至少能容纳约8个块（控制头部浪费）
+        span_units_ = (stride_ * 8 + Slab_Region::SLAB_SIZE - 1) / Slab_Region::SLAB_SIZE;
+
+        // 本级别的自然对齐：块大小的最低位2的幂（页大小封顶，不低于池对齐）。
+        // 数据区偏移按它取整后，块步长又是块大小本身，因此每个块都天然对齐，
+        // allocate_aligned只需挑选自然对齐足够大的级别。
+        natural_alignment_ = block_size_ & (~block_size_ + 1);
+        if (natural_alignment_ > 4096) {
+            natural_alignment_ = 4096;
+        }
+        if (natural_alignment_ < alignment_) {
+            natural_alignment_ = alignment_;
+        }
+#ifdef MEMORY_POOL_DEBUG
+        // 调试尾巴让步长不再等于块大小，高于池对齐的自然对齐不再成立；
+        // 调试构建下大对齐请求会退到malloc直通路径（其对齐逻辑不受影响）
+        natural_alignment_ = alignment_;
+#endif
+
+        // 计算slab布局：头部 + in_use位图 + 已知零位图 + 对齐后的数据区
+        size_t span_bytes = span_units_ * Slab_Region::SLAB_SIZE;
+        size_t max_count = (span_bytes - sizeof(Slab_Header)) / stride_;
+        bitmap_words_ = (max_count + 63) / 64;
+        data_offset_ = (sizeof(Slab_Header) + bitmap_words_ * 8 * 2 + natural_alignment_ - 1) &
+                       ~(natural_alignment_ - 1);
+        blocks_per_slab_ = (span_bytes - data_offset_) / stride_;
     }
 
-    // 分配一个内存块
-    void *allocate() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (!free_blocks_.empty()) {
-            // 快速路径：从空闲链表获取
-            void *ptr = free_blocks_.front();
-            free_blocks_.pop_front();
-            current_used_++;
-            current_free_--;
-            return ptr;
+    ~Fixed_Size_Pool() {
+        // 把所有slab归还给区域（此时外部必须已停止使用该池的内存）
+        while (slabs_) {
+            Slab_Header *next = slabs_->next;
+            region_->release_slab(slabs_, span_units_);
+            slabs_ = next;
         }
+    }
 
-        // 慢速路径：需要分配新块
-        // 计算总大小：头部 + 对齐后的块大小
-        size_t header_size = (sizeof(Memory_Block_Header) + alignment_ - 1) & ~(alignment_ - 1);
-        size_t total_size = header_size + block_size_;
+    // 从块指针反推所属slab头部（区域按64KB单元维护映射表）
+    Slab_Header *slab_of(void *ptr) const { return region_->slab_at(ptr); }
 
-        // 分配内存
-        void *raw_ptr = std::malloc(total_size);
-        if (!raw_ptr) {
-            return nullptr;
+    // 分配一个内存块（was_zero非空时带出该块是否已知为零）
+    void *allocate(bool *was_zero = nullptr) {
+        // 快速路径：无锁弹出一个空闲块
+        void *ptr = pop_free();
+        if (!ptr && drain_remote()) {
+            ptr = pop_free(); // 收件箱里攒着远程释放的块，摘下来接着用
+        }
+        if (!ptr) {
+            // 慢速路径：空闲栈耗尽，加锁分配一个新slab
+            slow_path_count_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ptr = pop_free(); // 其他线程可能刚补充过
+            while (!ptr) {
+                if (!allocate_slab()) {
+                    return nullptr;
+                }
+                ptr = pop_free();
+            }
         }
 
-        // 设置头部信息
-        Memory_Block_Header *header = reinterpret_cast<Memory_Block_Header *>(raw_ptr);
-        header->size = block_size_;
-        header->block_size = block_size_;
-        header->in_use = true;
-        header->pool_ptr = this;
+        Slab_Header *slab = slab_of(ptr);
+        mark_in_use(slab, ptr);
+        bool zero = consume_zero_state(slab, ptr);
+        if (was_zero) {
+            *was_zero = zero;
+        }
+        slab->free_in_list.fetch_sub(1, std::memory_order_relaxed);
 
-        // 返回用户可用的内存地址（跳过头部）
-        void *user_ptr = static_cast<char *>(raw_ptr) + header_size;
+        alloc_count_.fetch_add(1, std::memory_order_relaxed);
         current_used_++;
-        total_allocated_++;
-        return user_ptr;
+        current_free_--;
+        return ptr;
     }
 
-    // 释放一个内存块
+    // 分配一个内容清零的块：已知零的块（新slab或后台预零化）只需擦掉
+    // 空闲链表的next字，完全跳过memset；脏块按块大小清零
+    void *allocate_zeroed() {
+        bool was_zero = false;
+        void *ptr = allocate(&was_zero);
+        if (!ptr) {
+            return nullptr;
+        }
+        if (was_zero) {
+            std::memset(ptr, 0, sizeof(void *));
+        } else {
+            std::memset(ptr, 0, block_size_);
+        }
+        return ptr;
+    }
+
+    // 批量分配一条侵入式块链（用于TLS缓存补充）：最多取want个块，块首8字节
+    // 串成next链（nullptr结尾），经out_first带出链头并返回实际数量。
+    // 链节点就是块本身，补充整批缓存没有任何辅助分配。
+    size_t allocate_chain(void **out_first, size_t want) {
+        void *first = nullptr;
+        void *last = nullptr;
+        size_t got = 0;
+        while (got < want) {
+            void *ptr = pop_free();
+            if (!ptr && drain_remote()) {
+                ptr = pop_free();
+            }
+            if (!ptr) {
+                slow_path_count_.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(mutex_);
+                ptr = pop_free();
+                if (!ptr) {
+                    if (!allocate_slab()) {
+                        break;
+                    }
+                    ptr = pop_free();
+                    if (!ptr) {
+                        break;
+                    }
+                }
+            }
+
+            Slab_Header *slab = slab_of(ptr);
+            mark_in_use(slab, ptr);
+            consume_zero_state(slab, ptr); // 进入TLS缓存的块视为脏块
+            slab->free_in_list.fetch_sub(1, std::memory_order_relaxed);
+
+            *static_cast<void **>(ptr) = nullptr;
+            if (!first) {
+                first = ptr;
+            } else {
+                *static_cast<void **>(last) = ptr;
+            }
+            last = ptr;
+            got++;
+        }
+
+        alloc_count_.fetch_add(got, std::memory_order_relaxed);
+        current_used_ += got;
+        current_free_ -= got;
+        *out_first = first;
+        return got;
+    }
+
+    // 释放一条侵入式块链（用于TLS缓存溢出）：逐块校验后把接受的块
+    // 重新串链、一次性压入远程收件箱
+    void deallocate_chain(void *chain) {
+        auto now = std::chrono::steady_clock::now();
+        int64_t now_ns = now.time_since_epoch().count();
+
+        void *first = nullptr;
+        void *last = nullptr;
+        size_t accepted = 0;
+        while (chain) {
+            void *ptr = chain;
+            chain = *static_cast<void **>(ptr);
+
+            Slab_Header *slab = slab_of(ptr);
+            if (!is_valid_block(slab, ptr) || !mark_free(slab, ptr)) {
+                // 无效指针或双重释放
+#ifdef MEMORY_POOL_DEBUG
+                debug_abort_on_bad_free(slab, ptr);
+#endif
+                continue;
+            }
+
+            slab->free_in_list.fetch_add(1, std::memory_order_relaxed);
+            slab->last_return_ns.store(now_ns, std::memory_order_relaxed);
+
+            if (!first) {
+                first = ptr;
+            } else {
+                *static_cast<void **>(last) = ptr;
+            }
+            last = ptr;
+            accepted++;
+        }
+
+        if (accepted > 0) {
+            push_remote_chain(first, last);
+            free_count_.fetch_add(accepted, std::memory_order_relaxed);
+            current_used_ -= accepted;
+            current_free_ += accepted;
+        }
+    }
+
+    // 释放一个内存块（无锁）
     void deallocate(void *ptr) {
         if (!ptr) {
             return;
         }
 
-        // 从用户指针计算头部地址
-        size_t header_size =
-            (sizeof(Memory_Block_Header) + alignment_ - 1) & ~(alignment_ - 1);
-        Memory_Block_Header *header =
-            reinterpret_cast<Memory_Block_Header *>(static_cast<char *>(ptr) - header_size);
-
-        // 验证头部信息
-        if (header->pool_ptr != this || !header->in_use) {
-            // 无效的释放操作，可能是双重释放
+        // 从指针反推slab并校验（位图同时拦截双重释放）
+        Slab_Header *slab = slab_of(ptr);
+        if (!is_valid_block(slab, ptr) || !mark_free(slab, ptr)) {
+#ifdef MEMORY_POOL_DEBUG
+            debug_abort_on_bad_free(slab, ptr);
+#endif
             return;
         }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        header->in_use = false;
-        header->last_return_time = std::chrono::steady_clock::now();
-        free_blocks_.push_back(ptr);
+        slab->free_in_list.fetch_add(1, std::memory_order_relaxed);
+        slab->last_return_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                   std::memory_order_relaxed);
+
+        push_remote_chain(ptr, ptr);
+        free_count_.fetch_add(1, std::memory_order_relaxed);
         current_used_--;
         current_free_++;
     }
 
     size_t get_block_size() const { return block_size_; }
+    size_t get_natural_alignment() const { return natural_alignment_; }
     size_t get_current_used() const { return current_used_; }
     size_t get_current_free() const { return current_free_; }
     size_t get_total_allocated() const { return total_allocated_; }
+    size_t get_alloc_count() const { return alloc_count_.load(std::memory_order_relaxed); }
+    size_t get_free_count() const { return free_count_.load(std::memory_order_relaxed); }
+    size_t get_slow_path_count() const { return slow_path_count_.load(std::memory_order_relaxed); }
 
     // 获取空闲块数量（用于统计）
     size_t get_free_block_count() const { return current_free_.load(); }
 
-    // 清理过多的空闲块（释放部分空闲块回操作系统）
-    // max_free_blocks: 保留的最大空闲块数，超过的部分会被释放
-    size_t cleanup_excess_blocks(size_t max_free_blocks) {
+    // 预留空闲块：预分配slab直到空闲块数不低于min_free（预热用）。
+    // slab切分时会把next链写进每个块，数据页随之全部预缺页——冷启动的
+    // 首批分配既不进slab慢速路径，也不吃缺页中断。返回当前的空闲块数
+    //（区域耗尽或预算不足时可能低于min_free）。
+    size_t reserve_blocks(size_t min_free) {
         std::lock_guard<std::mutex> lock(mutex_);
-        size_t released_count = 0;
-
-        // 如果空闲块数量超过限制，释放多余的部分
-        while (free_blocks_.size() > max_free_blocks && !free_blocks_.empty()) {
-            void *ptr = free_blocks_.front();
-            free_blocks_.pop_front();
-
-            // 从用户指针计算原始内存地址（需要找到头部）
-            size_t header_size =
-                (sizeof(Memory_Block_Header) + alignment_ - 1) & ~(alignment_ - 1);
-            void *raw_ptr = static_cast<char *>(ptr) - header_size;
+        while (current_free_.load(std::memory_order_relaxed) < min_free) {
+            if (!allocate_slab()) {
+                break;
+            }
+        }
+        return current_free_.load(std::memory_order_relaxed);
+    }
 
-            // 释放内存回操作系统
-            std::free(raw_ptr);
-            current_free_--;
-            total_allocated_--;
-            released_count++;
+    // 清理过多的空闲块（以slab为单位释放回操作系统，单次至多max_slabs个）
+    // max_free_blocks: 保留的最大空闲块数，超过时释放完全空闲的slab
+    // 返回本次释放的slab数量
+    size_t cleanup_excess_blocks(size_t max_free_blocks, size_t max_slabs = SIZE_MAX) {
+        size_t free_count = current_free_.load();
+        if (free_count <= max_free_blocks) {
+            return 0;
         }
-        return released_count;
+
+        // 贪心选择完全空闲的slab，直到释放量覆盖超出的部分
+        size_t excess = free_count - max_free_blocks;
+        return release_slabs_if(
+            [&excess](Slab_Header *slab) {
+                if (excess == 0) {
+                    return false;
+                }
+                excess -= std::min(excess, slab->block_count);
+                return true;
+            },
+            max_slabs);
     }
 
-    // 清理超时的空闲块（基于最后归还时间）
-    // idle_timeout: 空闲超时时间，超过这个时间的空闲块会被释放
-    size_t cleanup_idle_blocks_by_time(std::chrono::seconds idle_timeout) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t released_count = 0;
-        auto now = std::chrono::steady_clock::now();
+    // 后台预零化：摘下整条空闲栈（此后独占这些块），把至多max_blocks个脏块
+    // 清零并标记为已知零，再整链放回。只清next字之后的部分，链表结构不动。
+    // 摘链期间其他线程的分配会短暂走slab慢速路径，因此由清理线程限量调用。
+    // 返回本次清零的块数（等于max_blocks时说明可能还有脏块积压）。
+    size_t pre_zero_free_blocks(size_t max_blocks) {
+#ifdef MEMORY_POOL_DEBUG
+        // 调试模式下空闲块带毒值，后台清零会抹掉毒值造成验毒误报，整体关闭
+        //（allocate_zeroed退化为全量memset，正确性不变）
+        (void)max_blocks;
+        return 0;
+#else
+        if (max_blocks == 0 || current_free_.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        drain_remote(); // 收件箱里的脏块也纳入本轮预零化
+        void *chain = detach_all();
+        if (!chain) {
+            return 0;
+        }
 
-        // 遍历空闲块链表，找出超时的块
-        std::list<void *> valid_blocks;
-        size_t header_size =
-            (sizeof(Memory_Block_Header) + alignment_ - 1) & ~(alignment_ - 1);
-
-        while (!free_blocks_.empty()) {
-            void *ptr = free_blocks_.front();
-            free_blocks_.pop_front();
-
-            // 从用户指针计算头部地址
-            Memory_Block_Header *header =
-                reinterpret_cast<Memory_Block_Header *>(static_cast<char *>(ptr) - header_size);
-
-            // 检查是否超时
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - header->last_return_time);
-            if (elapsed >= idle_timeout) {
-                // 超时了，释放这个块
-                void *raw_ptr = static_cast<char *>(ptr) - header_size;
-                std::free(raw_ptr);
-                current_free_--;
-                total_allocated_--;
-                released_count++;
-            } else {
-                // 未超时，保留这个块
-                valid_blocks.push_back(ptr);
+        size_t zeroed = 0;
+        void *last = chain;
+        for (void *ptr = chain; ptr; ptr = *static_cast<void **>(ptr)) {
+            last = ptr;
+            if (zeroed >= max_blocks) {
+                continue; // 预算用尽，只继续找链尾
+            }
+            Slab_Header *slab = slab_of(ptr);
+            if (!test_zero_state(slab, ptr)) {
+                std::memset(static_cast<char *>(ptr) + sizeof(void *), 0,
+                            block_size_ - sizeof(void *));
+                set_zero_state(slab, ptr);
+                zeroed++;
             }
         }
 
-        // 将有效的块放回空闲链表
-        free_blocks_ = std::move(valid_blocks);
-        return released_count;
+        push_free_chain(chain, last);
+        return zeroed;
+#endif
+    }
+
+    // 清理超时的空闲slab（基于slab内最后一次归还时间，单次至多max_slabs个）
+    // idle_timeout: 空闲超时时间，完全空闲且超过这个时间的slab会被释放
+    // 返回本次释放的slab数量
+    size_t cleanup_idle_blocks_by_time(std::chrono::seconds idle_timeout,
+                                       size_t max_slabs = SIZE_MAX) {
+        int64_t now_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+        int64_t timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(idle_timeout).count();
+
+        return release_slabs_if(
+            [now_ns, timeout_ns](Slab_Header *slab) {
+                return now_ns - slab->last_return_ns.load(std::memory_order_relaxed) >= timeout_ns;
+            },
+            max_slabs);
     }
 };
 
-// 线程局部缓存（每个线程维护自己的小块内存缓存）
-struct Thread_Local_Cache {
-    std::vector<void *> cache[8]; // 8个不同大小的缓存（对应8、16、32、64、128、256、512、1024字节）
-    size_t cache_size = 16;       // 每个缓存的最大容量
+// 小块级别表的编译期描述：级别按严格升序排列，部署方可以按自己的
+// 对象大小直方图定制几何（例如Size_Classes<40, 72, 96, 128, 256, 512, 1024>），
+// TLS缓存数组和查找表会在编译期自动按级别数取尺寸。
+template <size_t... Sizes> struct Size_Classes {
+    static_assert(sizeof...(Sizes) > 0, "Size_Classes needs at least one class");
+    static constexpr size_t count = sizeof...(Sizes);
+    static constexpr size_t sizes[count] = {Sizes...};
+    static constexpr size_t max_size = sizes[count - 1];
+};
+
+// 编译期校验级别表严格升序（Basic_Memory_Pool内部使用）
+template <typename Classes> constexpr bool size_classes_sorted() {
+    for (size_t i = 1; i < Classes::count; ++i) {
+        if (Classes::sizes[i] <= Classes::sizes[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 默认几何：8个2的幂级别（8B到1024B）
+using Default_Size_Classes = Size_Classes<8, 16, 32, 64, 128, 256, 512, 1024>;
+
+// 单个级别的统计快照（get_stats_snapshot的组成部分）
+// 按级别看分配量就是一张大小直方图；slow_path_count是该级别的锁竞争/扩容信号，
+// tls_hit/tls_miss反映线程缓存对该级别的吸收效果（仅小块级别有意义）。
+struct Pool_Class_Stats {
+    size_t block_size = 0;         // 级别的块大小（按对齐取整后的实际值）
+    size_t used_blocks = 0;        // 当前使用中的块数
+    size_t free_blocks = 0;        // 当前空闲的块数
+    size_t total_blocks = 0;       // 当前持有的块总数（used+free，slab粒度）
+    size_t global_alloc_count = 0; // 全局池累计发出的块数（含TLS批量补充）
+    size_t global_free_count = 0;  // 全局池累计收回的块数（含TLS批量溢出）
+    size_t slow_path_count = 0;    // 空闲栈耗尽、进入加锁slab路径的次数
+    size_t tls_hit_count = 0;      // TLS缓存直接命中的分配次数（中/大块级别恒为0）
+    size_t tls_miss_count = 0;     // TLS缓存为空、需要去全局池补充的次数
+};
+
+// 单个调用点标签的统计快照（标签按指针身份聚合，建议传字符串字面量）
+struct Pool_Tag_Stats {
+    const char *tag = nullptr; // 分配时传入的标签
+    size_t alloc_count = 0;    // 该标签下的累计分配次数
+    size_t allocated_bytes = 0; // 该标签下的累计请求字节数
+};
+
+// 结构化统计快照：get_stats_snapshot()返回，字段可直接喂给监控系统
+// （例如逐级别导出为Prometheus的counter/gauge），不必解析get_stats()的文本。
+// 各计数来自relaxed原子读，快照整体不保证瞬时一致，适合趋势观察。
+struct Pool_Stats_Snapshot {
+    size_t total_allocated_bytes = 0; // 累计分配字节数
+    size_t total_freed_bytes = 0;     // 累计释放字节数
+    size_t alloc_count = 0;           // 累计分配次数（含malloc直通的大块）
+    size_t free_count = 0;            // 累计释放次数
+    std::vector<Pool_Class_Stats> classes; // 逐级别统计（小块级别在前）
+    std::vector<Pool_Tag_Stats> tags;      // 逐调用点标签统计（未用标签时为空）
+};
+
+// 异步命令句柄（request_stats_snapshot/request_cleanup使用）：由调用方持有，
+// 经无锁命令通道投给清理线程执行，完成状态通过done()发布。句柄的生命周期
+// 必须覆盖到done()为true（或wait()返回）之后；完成之前不得重复投递，
+// 完成之后可以复用再次投递。
+class Pool_Async_Command {
+  public:
+    // 结果字段：done()为true后读取
+    Pool_Stats_Snapshot snapshot; // 快照命令的结果
+    size_t released_slabs = 0;    // 清理命令的结果：本轮释放的slab总数
+
+    // 可选完成回调：在清理线程上执行，触发时结果字段已就绪（done()随后才
+    // 置位）。回调内只允许轻量操作，不得调用池的阻塞接口、重新投递或销毁
+    // 本句柄——句柄无论如何都要存活到done()为真之后
+    std::function<void()> on_complete;
+
+    Pool_Async_Command() = default;
+    Pool_Async_Command(const Pool_Async_Command &) = delete;
+    Pool_Async_Command &operator=(const Pool_Async_Command &) = delete;
+
+    // 无锁查询是否完成（acquire与执行方的release配对，结果字段可安全读取）
+    bool done() const { return done_.load(std::memory_order_acquire); }
+
+    // 等待完成：命令执行只差一次清理线程唤醒（微秒级），让出式自旋即可；
+    // 低频轮询的监控线程直接用done()，连这点自旋都省掉
+    void wait() const {
+        while (!done()) {
+            std::this_thread::yield();
+        }
+    }
+
+  private:
+    template <typename> friend class Basic_Memory_Pool;
+
+    enum class Kind { Snapshot, Cleanup };
 
-    ~Thread_Local_Cache() {
-        // 析构时清理缓存（需要归还到全局池）
-        // 注意：这里需要访问全局池，但为了避免循环依赖，由外部处理
+    Kind kind_ = Kind::Snapshot;
+    size_t budget_slabs_ = 0;            // 清理命令：每个池本轮最多处理的slab数（0=用配置值）
+    Pool_Async_Command *next_ = nullptr; // 命令通道的侵入式链指针
+    std::atomic<bool> done_{false};
+
+    // 执行方发布结果：先触发回调，最后置位完成标志——这次release写是执行方
+    // 对句柄的最后一次触碰，提交方看到done()为真后即可安全销毁/复用句柄
+    void complete() {
+        if (on_complete) {
+            on_complete();
+        }
+        done_.store(true, std::memory_order_release);
     }
 };
 
-class Memory_Pool {
+// 内存预算耗尽时的处理策略（set_limit_policy设置）
+enum class Memory_Limit_Policy {
+    Fail_Fast, // 立即返回nullptr（默认）
+    Block,     // 阻塞等待别处释放配额后重试
+    Callback,  // 调用应用提供的甩负载回调，回调返回true则重试
+};
+
+template <typename Small_Classes = Default_Size_Classes> class Basic_Memory_Pool {
   private:
+    static_assert(size_classes_sorted<Small_Classes>(),
+                  "Size_Classes must be strictly ascending");
+    static_assert(Small_Classes::max_size < 2 * 1024,
+                  "small classes must stay below the first medium class (2KB)");
+    static_assert(Small_Classes::count + 6 <= 127,
+                  "too many size classes for the int8_t lookup table");
+
     // 内存池配置结构
     struct PoolConfig {
-        size_t small_block_sizes[8] = {8, 16, 32, 64, 128, 256, 512, 1024}; // 小块内存级别
+        size_t small_block_sizes[Small_Classes::count]; // 小块内存级别（由模板几何决定）
+        size_t medium_block_sizes[6] = {2 * 1024,  4 * 1024,  8 * 1024,
+                                        16 * 1024, 32 * 1024, 64 * 1024}; // 中/大块级别（页倍数）
         size_t max_total_memory = 1024 * 1024 * 1024;                       // 最大总内存（1GB）
+        Memory_Limit_Policy limit_policy =
+            Memory_Limit_Policy::Fail_Fast;       // 预算耗尽时的处理策略
+        std::function<bool()> limit_callback;     // Callback策略的甩负载回调
         size_t alignment = 8;                                               // 内存对齐大小
         bool enable_tls = true;                                             // 是否启用线程局部存储
-        size_t tls_cache_size = 16;                                         // 每个线程的缓存大小
+        size_t tls_cache_size = 16;          // 每个级别TLS缓存的初始容量
+        size_t tls_min_cache_size = 4;       // 自适应收缩的容量下限
+        size_t tls_max_cache_size = 256;     // 自适应增长的容量上限
+        size_t tls_cache_byte_budget = 64 * 1024; // 每线程TLS缓存的总字节预算
+        size_t tls_adapt_interval = 4096;    // 每多少次分配操作调整一次各级别容量
         std::chrono::seconds cleanup_interval =
             std::chrono::seconds(30); // 清理间隔
         std::chrono::seconds idle_timeout =
             std::chrono::seconds(300); // 空闲超时时间
+        size_t cleanup_batch_slabs = 8; // 每个池每周期最多释放的slab数（限制清理引入的停顿）
+        Slab_Release_Mode slab_release_mode =
+            Slab_Release_Mode::Decommit; // 空闲slab的物理页归还方式
+        size_t numa_shards = 1;         // 每个级别的NUMA分片数（1=关闭，0=按检测到的节点数）
+        size_t pre_zero_batch_blocks = 64; // 每个池每清理周期后台预零化的空闲块数（0=关闭）
     } config_;
 
-    // 内存池统计信息
-    struct PoolStats {
-        std::atomic<size_t> total_allocated; // 总分配内存大小（字节）
-        std::atomic<size_t> total_freed;     // 总释放内存大小（字节）
-        std::atomic<size_t> current_used;    // 当前使用中的内存大小（字节）
-        std::atomic<size_t> current_free;    // 当前空闲的内存大小（字节）
-        std::atomic<size_t> alloc_count;     // 分配次数
-        std::atomic<size_t> free_count;      // 释放次数
-        std::atomic<size_t> fragment_count;  // 碎片数量
-    } stats_;
+    static constexpr size_t SMALL_CLASS_COUNT = Small_Classes::count; // 小块级别数（走TLS缓存）
+    static constexpr size_t MEDIUM_CLASS_COUNT = 6;                   // 中/大块级别数（只走全局池）
+
+    // 线程局部缓存（每个线程按内存池实例各维护一份小块缓存，数组随几何取尺寸）
+    // 生命周期由内存池和线程退出钩子共同管理：线程退出时缓存的块会被
+    // 归还到所属池的全局空闲栈；池先于线程析构时owner被置空，表示无需归还。
+    // 各级别的容量独立自适应：按命中/未命中统计，热级别增长、冷级别收缩。
+    struct Thread_Local_Cache {
+        Basic_Memory_Pool *owner = nullptr;             // 所属内存池（仅在注册锁保护下修改）
+        // 各级别的缓存是侵入式单链：块首8字节为next指针（与全局空闲栈同款），
+        // push/pop只是两次指针操作，缓存本身不占任何辅助内存
+        void *cache_head[SMALL_CLASS_COUNT] = {};       // 各级别的缓存链头（最近归还的在前）
+        size_t cache_count[SMALL_CLASS_COUNT] = {};     // 各级别当前缓存的块数
+        size_t capacity[SMALL_CLASS_COUNT] = {};        // 每个级别的当前容量（自适应调整）
+        uint32_t hits[SMALL_CLASS_COUNT] = {};          // 自上次调整以来的TLS命中次数
+        uint32_t misses[SMALL_CLASS_COUNT] = {};        // 需要去全局池补充的未命中次数
+        uint32_t ops_since_adapt = 0;                   // 距上次容量调整的分配操作数
+    };
+
+    // 分片统计：计数按线程散列到独立缓存行的分片上，增量使用relaxed原子操作，
+    // 避免所有核在同一组计数器缓存行上互相弹射；get_stats()时惰性汇总。
+    // 编译时定义 MEMORY_POOL_DISABLE_STATS 可以完全关闭统计（计数调用零开销）。
+    struct alignas(64) Stats_Shard {
+        std::atomic<size_t> allocated_bytes{0}; // 累计分配字节数
+        std::atomic<size_t> freed_bytes{0};     // 累计释放字节数
+        std::atomic<size_t> alloc_count{0};     // 分配次数
+        std::atomic<size_t> free_count{0};      // 释放次数
+    };
+    static constexpr size_t STATS_SHARD_COUNT = 16; // 分片数量（2的幂）
+
+    Stats_Shard stats_shards_[STATS_SHARD_COUNT]; // 统计分片数组
+
+    // 当前线程对应的统计分片（线程第一次进入时轮转分配一个分片）
+    Stats_Shard &stats_shard() {
+        static std::atomic<size_t> next_index{0};
+        static thread_local size_t shard_index =
+            next_index.fetch_add(1, std::memory_order_relaxed) % STATS_SHARD_COUNT;
+        return stats_shards_[shard_index];
+    }
+
+    // 记录一次分配（bytes为该级别的块大小或大块的实际大小）
+    void record_alloc(size_t bytes) {
+#ifndef MEMORY_POOL_DISABLE_STATS
+        Stats_Shard &shard = stats_shard();
+        shard.alloc_count.fetch_add(1, std::memory_order_relaxed);
+        shard.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+#else
+        (void)bytes;
+#endif
+    }
+
+    // 记录一次释放
+    void record_free(size_t bytes) {
+#ifndef MEMORY_POOL_DISABLE_STATS
+        Stats_Shard &shard = stats_shard();
+        shard.free_count.fetch_add(1, std::memory_order_relaxed);
+        shard.freed_bytes.fetch_add(bytes, std::memory_order_relaxed);
+#else
+        (void)bytes;
+#endif
+    }
+
+    // 汇总所有分片的累计分配字节数
+    size_t sum_allocated_bytes() const {
+        size_t total = 0;
+        for (const Stats_Shard &shard : stats_shards_) {
+            total += shard.allocated_bytes.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 汇总所有分片的累计释放字节数
+    size_t sum_freed_bytes() const {
+        size_t total = 0;
+        for (const Stats_Shard &shard : stats_shards_) {
+            total += shard.freed_bytes.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 池级的TLS命中/未命中累计：各线程缓存的观察窗口在容量调整和线程退出时
+    // 把窗口计数并入这里，热路径上不碰这组共享计数器
+    std::atomic<size_t> tls_hit_counts_[SMALL_CLASS_COUNT] = {};
+    std::atomic<size_t> tls_miss_counts_[SMALL_CLASS_COUNT] = {};
+
+    // 把线程缓存当前观察窗口的命中统计并入池级计数（调用方随后清零窗口）
+    void flush_tls_counters(const Thread_Local_Cache *cache) {
+#ifndef MEMORY_POOL_DISABLE_STATS
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            tls_hit_counts_[i].fetch_add(cache->hits[i], std::memory_order_relaxed);
+            tls_miss_counts_[i].fetch_add(cache->misses[i], std::memory_order_relaxed);
+        }
+#else
+        (void)cache;
+#endif
+    }
+
+    // 调用点标签统计：tag指针→(分配次数, 累计字节数)。只有带标签的分配
+    // 才走这把锁，不影响未打标签的热路径。
+    mutable std::mutex tag_mutex_;
+    std::unordered_map<const char *, std::pair<size_t, size_t>> tag_stats_;
+
+    std::unique_ptr<Memory_Budget> budget_;               // 内存预算（slab提交和大块分配共用）
+    std::unique_ptr<Slab_Region> slab_region_;            // slab地址区域（先于pools_构造，后于其析构）
+    std::unique_ptr<Epoch_Reclaimer> reclaimer_;          // 纪元回收器（析构时冲刷灵薄链）
+    std::vector<std::unique_ptr<Fixed_Size_Pool>> pools_; // 多级内存池数组
+    std::vector<int8_t> size_class_table_;                // 大小→池索引查找表（O(1)映射）
+    size_t max_pooled_size_ = 0;                          // 最大的池化级别（查找表上限）
+    size_t numa_shard_count_ = 1;                         // 每个级别的分片数（NUMA节点粒度）
+    std::vector<int> cpu_to_shard_;                       // cpu→分片映射（按cpu所属NUMA节点）
+    std::mutex mutex_;                                    // 全局互斥锁（用于大块内存）
+    std::atomic<bool> shutdown_;                          // 内存池是否关闭
+    std::thread cleaner_thread_;                          // 清理线程
+    std::mutex cleanup_mutex_;                            // 清理线程的等待互斥锁
+    std::condition_variable cleanup_cv_;                  // 用于及时唤醒/停止清理线程
+    // 无锁命令通道（MPSC：任意线程CAS入队，清理线程整体摘除——与远程释放
+    // 收件箱同款的侵入式栈，提交方不触碰任何热路径锁）
+    alignas(64) std::atomic<Pool_Async_Command *> command_head_{nullptr};
+
+    // 第index个池对应的级别大小（小块级别在前，中/大块级别在后）
+    size_t class_size(size_t index) const {
+        return index < SMALL_CLASS_COUNT ? config_.small_block_sizes[index]
+                                         : config_.medium_block_sizes[index - SMALL_CLASS_COUNT];
+    }
+
+    // 构建大小→池索引的查找表（每字节一项），热路径上不再按级别扫描。
+    // 表界按对齐取整后的级别大小计算，与Fixed_Size_Pool实际持有的块大小一致，
+    // 释放路径用块大小反查索引时才能命中正确的级别。
+    void build_size_class_table() {
+        max_pooled_size_ = config_.medium_block_sizes[MEDIUM_CLASS_COUNT - 1];
+        size_class_table_.resize(max_pooled_size_ + 1);
+        int pool_index = 0;
+        for (size_t size = 0; size <= max_pooled_size_; ++size) {
+            while (size > ((class_size(pool_index) + config_.alignment - 1) &
+                           ~(config_.alignment - 1))) {
+                pool_index++;
+            }
+            size_class_table_[size] = static_cast<int8_t>(pool_index);
+        }
+    }
+
+    // 根据大小找到对应的内存池索引（-1表示使用系统malloc），O(1)查表
+    int find_pool_index(size_t size) {
+        return size <= max_pooled_size_ ? size_class_table_[size] : -1;
+    }
+
+    // 检测NUMA节点数（Linux下读sysfs，其他平台视为单节点）
+    static size_t detect_numa_node_count() {
+#if defined(__linux__)
+        size_t nodes = 0;
+        while (access(("/sys/devices/system/node/node" + std::to_string(nodes)).c_str(),
+                      F_OK) == 0) {
+            nodes++;
+        }
+        return nodes > 0 ? nodes : 1;
+#else
+        return 1;
+#endif
+    }
+
+    // 构建cpu→分片映射：按cpu所属NUMA节点分片（节点数多于分片数时取模归并）。
+    // 读不到sysfs时映射保持为空，current_shard()退化为cpu编号取模。
+    void build_cpu_shard_table() {
+#if defined(__linux__)
+        long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+        if (cpu_count <= 0) {
+            return;
+        }
+        cpu_to_shard_.assign(static_cast<size_t>(cpu_count), -1);
+        for (size_t node = 0;; ++node) {
+            std::string path =
+                "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+            FILE *file = std::fopen(path.c_str(), "r");
+            if (!file) {
+                break;
+            }
+            // cpulist形如"0-15,32-47"：逐段解析区间并标记归属
+            char buffer[4096];
+            if (std::fgets(buffer, sizeof(buffer), file)) {
+                char *cursor = buffer;
+                while (*cursor) {
+                    char *end = nullptr;
+                    long first = std::strtol(cursor, &end, 10);
+                    if (end == cursor) {
+                        break;
+                    }
+                    long last = first;
+                    if (*end == '-') {
+                        cursor = end + 1;
+                        last = std::strtol(cursor, &end, 10);
+                    }
+                    for (long cpu = first; cpu <= last && cpu < cpu_count; ++cpu) {
+                        cpu_to_shard_[cpu] = static_cast<int>(node % numa_shard_count_);
+                    }
+                    cursor = (*end == ',') ? end + 1 : end;
+                }
+            }
+            std::fclose(file);
+        }
+#endif
+    }
+
+    // 当前线程应使用的分片（按线程此刻所在cpu的NUMA节点选择）
+    size_t current_shard() const {
+        if (numa_shard_count_ <= 1) {
+            return 0;
+        }
+#if defined(_WIN32)
+        return GetCurrentProcessorNumber() % numa_shard_count_;
+#elif defined(__linux__)
+        int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            if (static_cast<size_t>(cpu) < cpu_to_shard_.size() && cpu_to_shard_[cpu] >= 0) {
+                return static_cast<size_t>(cpu_to_shard_[cpu]);
+            }
+            return static_cast<size_t>(cpu) % numa_shard_count_;
+        }
+        return 0;
+#else
+        // 取不到cpu编号的平台按线程散列，至少把竞争摊开
+        return std::hash<std::thread::id>()(std::this_thread::get_id()) % numa_shard_count_;
+#endif
+    }
+
+    // 第class_index级别在指定分片上的池（池数组按[级别][分片]平铺）
+    Fixed_Size_Pool *pool_at(size_t class_index, size_t shard) const {
+        return pools_[class_index * numa_shard_count_ + shard].get();
+    }
+
+    // 当前线程应优先使用的池（本节点分片；slab由本节点线程首次触碰，
+    // 依靠first-touch策略落在本地内存上）
+    Fixed_Size_Pool *pool_for(int pool_index) const {
+        return pool_at(static_cast<size_t>(pool_index), current_shard());
+    }
+
+    // 判断池指针是否是本实例第class_index级别的某个分片（释放路径的归属校验）
+    bool owns_pool(size_t class_index, const Fixed_Size_Pool *pool) const {
+        for (size_t shard = 0; shard < numa_shard_count_; ++shard) {
+            if (pool_at(class_index, shard) == pool) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 把一条同级别的侵入式块链按各自归属的分片分段归还。块总是回到它
+    // 诞生的分片，这样跨节点释放不会把页面"搬"到远端节点的空闲链表上。
+    // （TLS缓存不区分分片，线程跨节点迁移后缓存里可能混有多个分片的块）
+    void spill_chain(int pool_index, void *chain) {
+        if (numa_shard_count_ == 1) {
+            pools_[pool_index]->deallocate_chain(chain);
+            return;
+        }
+        while (chain) {
+            Slab_Header *slab = slab_region_->slab_at(chain);
+            Fixed_Size_Pool *home = slab ? slab->pool : nullptr;
+            // 沿链找出连续同归属的一段并断开
+            void *segment_last = chain;
+            void *next = *static_cast<void **>(chain);
+            while (next) {
+                Slab_Header *next_slab = slab_region_->slab_at(next);
+                if ((next_slab ? next_slab->pool : nullptr) != home) {
+                    break;
+                }
+                segment_last = next;
+                next = *static_cast<void **>(next);
+            }
+            *static_cast<void **>(segment_last) = nullptr;
+            if (home) {
+                home->deallocate_chain(chain);
+            }
+            chain = next;
+        }
+    }
+
+    // 保留缓存链头的keep个块（链头是最近归还的热块），把较冷的尾链
+    // 整条溢出回全局池（缓存溢出、容量收缩和线程退出共用）
+    void spill_tail(int pool_index, Thread_Local_Cache *cache, size_t keep) {
+        if (cache->cache_count[pool_index] <= keep) {
+            return;
+        }
+        void *tail;
+        if (keep == 0) {
+            tail = cache->cache_head[pool_index];
+            cache->cache_head[pool_index] = nullptr;
+        } else {
+            void *cut = cache->cache_head[pool_index];
+            for (size_t i = 1; i < keep; ++i) {
+                cut = *static_cast<void **>(cut);
+            }
+            tail = *static_cast<void **>(cut);
+            *static_cast<void **>(cut) = nullptr;
+        }
+        cache->cache_count[pool_index] = keep;
+        spill_chain(pool_index, tail);
+    }
+
+    // 按预算策略执行一次分配：Fail_Fast直接返回nullptr；Block等待别处
+    // 释放配额；Callback交给应用甩负载，回调返回true则重试。重试前先推
+    // 一轮清理，把各级别攒下的空闲slab归还给预算（否则要等清理周期）。
+    template <typename Alloc_Fn> void *allocate_with_limit(Alloc_Fn &&alloc_fn) {
+        void *ptr = alloc_fn();
+        while (!ptr && !shutdown_) {
+            if (config_.limit_policy == Memory_Limit_Policy::Fail_Fast) {
+                break;
+            }
+            if (config_.limit_policy == Memory_Limit_Policy::Callback) {
+                if (!config_.limit_callback || !config_.limit_callback()) {
+                    break;
+                }
+            } else if (!budget_->wait_for_room()) {
+                break;
+            }
+            cleanup_idle_blocks();
+            ptr = alloc_fn();
+        }
+        return ptr;
+    }
+
+    // 从指定级别完成一次池内分配：TLS快速路径 + 全局池回退 + 统计
+    void *allocate_from_class(int pool_index) {
+        void *ptr = allocate_from_tls(pool_index);
+        if (!ptr) {
+            // 慢速路径：从全局池分配（优先本NUMA节点的分片）
+            ptr = pool_for(pool_index)->allocate();
+        }
+        if (ptr) {
+            record_alloc(pool_at(pool_index, 0)->get_block_size());
+        }
+        return ptr;
+    }
+
+    // malloc直通的超大块分配：用户指针按alignment对齐，
+    // 头部紧贴在用户指针之前并记录malloc原始地址供释放使用。
+    // zeroed时改用calloc，让分配器/内核的零页机制代替显式memset。
+    void *allocate_large(size_t size, size_t alignment, bool zeroed = false) {
+        // 大块按请求大小计入预算（头部/对齐填充的零头不计，释放时按size释放配额）
+        if (!budget_->try_charge(size)) {
+            return nullptr;
+        }
+        size_t header_size =
+            (sizeof(Memory_Block_Header) + config_.alignment - 1) & ~(config_.alignment - 1);
+        size_t total = header_size + alignment + size;
+        void *raw_ptr = zeroed ? std::calloc(1, total) : std::malloc(total);
+        if (!raw_ptr) {
+            budget_->uncharge(size);
+            return nullptr;
+        }
+        uintptr_t user = (reinterpret_cast<uintptr_t>(raw_ptr) + header_size + alignment - 1) &
+                         ~(uintptr_t(alignment) - 1);
+        new (reinterpret_cast<char *>(user) - header_size) Memory_Block_Header{size, raw_ptr, true};
+        record_alloc(size);
+        return reinterpret_cast<void *>(user);
+    }
 
-    std::vector<std::unique_ptr<Fixed_Size_Pool>> pools_; // 多级内存池数组
-    std::mutex mutex_;                                    // 全局互斥锁（用于大块内存）
-    std::atomic<bool> shutdown_;                          // 内存池是否关闭
-    std::thread cleaner_thread_;                          // 清理线程
+    // 保护"池⇄线程缓存"注册关系的全局互斥锁（只在池/线程的生命周期边界使用）
+    static std::mutex &tls_registry_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
 
-    // 根据大小找到对应的内存池索引（-1表示使用系统malloc）
-    int find_pool_index(size_t size) {
-        for (int i = 0; i < 8; ++i) {
-            if (size <= config_.small_block_sizes[i]) {
-                return i;
+    // 每线程的缓存注册表：记录本线程为各个池创建的缓存，
+    // 线程退出时析构，把仍有归属的缓存冲刷回所属池并释放缓存对象本身
+    struct Thread_Cache_Registry {
+        std::vector<Thread_Local_Cache *> caches; // 本线程为各池创建的缓存
+        Basic_Memory_Pool *last_pool = nullptr;   // 上次命中的池（单池程序的快速路径）
+        Thread_Local_Cache *last_cache = nullptr; // 上次命中的缓存
+
+        ~Thread_Cache_Registry() {
+            std::lock_guard<std::mutex> lock(tls_registry_mutex());
+            for (Thread_Local_Cache *cache : caches) {
+                if (cache->owner) {
+                    cache->owner->retire_thread_cache(cache);
+                }
+                delete cache;
             }
         }
-        return -1; // 大于1024字节，使用系统malloc
+    };
+
+    std::vector<Thread_Local_Cache *> tls_caches_; // 所有线程为本池创建的缓存（注册锁保护）
+
+    // 线程退出钩子：把缓存的块全部归还到全局池并从本池注册表移除
+    // （调用方必须持有tls_registry_mutex）
+    void retire_thread_cache(Thread_Local_Cache *cache) {
+        flush_tls_counters(cache); // 最后一个观察窗口的命中统计不丢
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            spill_tail(static_cast<int>(i), cache, 0);
+        }
+        tls_caches_.erase(std::remove(tls_caches_.begin(), tls_caches_.end(), cache),
+                          tls_caches_.end());
     }
 
-    // 获取线程局部缓存（使用函数内静态thread_local避免ODR问题）
+    // 获取当前线程在本池上的局部缓存（每个池实例独立一份，避免跨池串用）
     Thread_Local_Cache *get_tls_cache() {
         if (!config_.enable_tls) {
             return nullptr;
         }
-        static thread_local Thread_Local_Cache *tls_cache = nullptr; // 线程局部缓存
-        static thread_local bool tls_initialized = false;            // 线程局部缓存是否初始化
+        static thread_local Thread_Cache_Registry registry;
+
+        // 快速路径：多数程序只有一个池实例。旧池析构时会把缓存的owner置空，
+        // 新池可能恰好复用旧池的地址，因此地址命中后还要验证归属仍然成立，
+        // 否则会捡起一个头指针指向已解除映射区域的僵尸缓存
+        if (registry.last_pool == this && registry.last_cache->owner == this) {
+            return registry.last_cache;
+        }
+        for (Thread_Local_Cache *cache : registry.caches) {
+            if (cache->owner == this) {
+                registry.last_pool = this;
+                registry.last_cache = cache;
+                return cache;
+            }
+        }
+
+        // 本线程第一次使用本池：创建缓存并在两边注册
+        // （缓存对象本身的分配不得路由回池，否则首次分配会无限递归）
+        Memory_Pool_Reentry_Guard reentry;
+        auto *cache = new Thread_Local_Cache();
+        cache->owner = this;
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            cache->capacity[i] = config_.tls_cache_size;
+        }
+        {
+            std::lock_guard<std::mutex> lock(tls_registry_mutex());
+            tls_caches_.push_back(cache);
+        }
+        registry.caches.push_back(cache);
+        registry.last_pool = this;
+        registry.last_cache = cache;
+        return cache;
+    }
+
+    // 自适应调整各级别的TLS缓存容量：未命中占比高的热级别容量翻倍，
+    // 完全没有流量的冷级别容量减半；总占用由字节预算约束，超出时
+    // 优先削减命中最少的级别。调整后超出容量的块立即溢出回全局池。
+    void adapt_tls_cache(Thread_Local_Cache *cache) {
+        flush_tls_counters(cache); // 窗口计数即将清零，先并入池级统计
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            uint32_t traffic = cache->hits[i] + cache->misses[i];
+            size_t cap = cache->capacity[i];
+            if (traffic > 0 && cache->misses[i] * 8 >= traffic) {
+                cap *= 2; // 超过1/8的分配要去全局池补充：缓存太浅
+            } else if (traffic == 0) {
+                cap /= 2; // 整个观察期无流量：释放冷级别占的内存
+            }
+            cache->capacity[i] = std::min(std::max(cap, config_.tls_min_cache_size),
+                                          config_.tls_max_cache_size);
+        }
+
+        // 字节预算约束：超出时逐次把命中最少且仍可收缩的级别减半
+        while (true) {
+            size_t total_bytes = 0;
+            for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+                total_bytes += cache->capacity[i] * Small_Classes::sizes[i];
+            }
+            if (total_bytes <= config_.tls_cache_byte_budget) {
+                break;
+            }
+            size_t coldest = SMALL_CLASS_COUNT;
+            for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+                if (cache->capacity[i] > config_.tls_min_cache_size &&
+                    (coldest == SMALL_CLASS_COUNT || cache->hits[i] < cache->hits[coldest])) {
+                    coldest = i;
+                }
+            }
+            if (coldest == SMALL_CLASS_COUNT) {
+                break; // 所有级别都已到下限
+            }
+            cache->capacity[coldest] = std::max(cache->capacity[coldest] / 2,
+                                                config_.tls_min_cache_size);
+        }
 
-        if (!tls_initialized) {
-            tls_cache = new Thread_Local_Cache();
-            tls_cache->cache_size = config_.tls_cache_size;
-            tls_initialized = true;
+        // 收缩后超出容量的块（较冷的尾链）溢出回全局池，并重置观察窗口
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            spill_tail(static_cast<int>(i), cache, cache->capacity[i]);
+            cache->hits[i] = 0;
+            cache->misses[i] = 0;
         }
-        return tls_cache;
+        cache->ops_since_adapt = 0;
     }
 
-    // 从线程局部缓存分配
+    // 从线程局部缓存分配（缓存为空时批量从全局池补充，摊薄同步开销）
+    // 只有小块级别走TLS；中/大块缓存收益低、占用高，直接走全局池
     void *allocate_from_tls(int pool_index) {
         Thread_Local_Cache *cache = get_tls_cache();
-        if (!cache || pool_index < 0 || pool_index >= 8) {
+        if (!cache || pool_index < 0 || pool_index >= static_cast<int>(SMALL_CLASS_COUNT)) {
             return nullptr;
         }
 
-        if (!cache->cache[pool_index].empty()) {
-            // 从TLS缓存获取
-            void *ptr = cache->cache[pool_index].back();
-            cache->cache[pool_index].pop_back();
-            return ptr;
+        if (++cache->ops_since_adapt >= config_.tls_adapt_interval) {
+            adapt_tls_cache(cache);
+        }
+
+        void *&head = cache->cache_head[pool_index];
+        if (!head) {
+            cache->misses[pool_index]++;
+            // 批量补充：一次从全局池取半缓存容量的块（整链接入，零辅助分配）
+            size_t batch = cache->capacity[pool_index] / 2;
+            if (batch == 0) {
+                batch = 1;
+            }
+            size_t got = pool_for(pool_index)->allocate_chain(&head, batch);
+            cache->cache_count[pool_index] = got;
+            if (got == 0) {
+                return nullptr;
+            }
+        } else {
+            cache->hits[pool_index]++;
         }
-        return nullptr;
+
+        void *ptr = head;
+        head = *static_cast<void **>(ptr);
+        cache->cache_count[pool_index]--;
+        return ptr;
     }
 
-    // 归还到线程局部缓存
+    // 归还到线程局部缓存（缓存满时一次性溢出一半回全局池）
     bool return_to_tls(int pool_index, void *ptr) {
         Thread_Local_Cache *cache = get_tls_cache();
-        if (!cache || pool_index < 0 || pool_index >= 8 || !ptr) {
+        if (!cache || pool_index < 0 || pool_index >= static_cast<int>(SMALL_CLASS_COUNT) ||
+            !ptr) {
             return false;
         }
 
-        if (cache->cache[pool_index].size() < cache->cache_size) {
-            // TLS缓存未满，直接加入
-            cache->cache[pool_index].push_back(ptr);
-            return true;
+        if (cache->cache_count[pool_index] >= cache->capacity[pool_index]) {
+            // TLS缓存已满：整链溢出较冷的尾部一半（链头是最近归还的热块）
+            size_t spill = cache->capacity[pool_index] / 2;
+            if (spill == 0) {
+                spill = 1;
+            }
+            size_t count = cache->cache_count[pool_index];
+            spill_tail(pool_index, cache, count > spill ? count - spill : 0);
         }
-        return false; // TLS缓存已满，需要归还到全局池
+
+        *static_cast<void **>(ptr) = cache->cache_head[pool_index];
+        cache->cache_head[pool_index] = ptr;
+        cache->cache_count[pool_index]++;
+        return true;
     }
 
-    // 清理空闲内存块
-    // 注意：固定大小池设计已经避免了碎片问题（相同大小的块可以完美复用）
-    // 每30秒执行一次，清理：
-    // 1. 基于空闲时间的清理：释放超过 idle_timeout 的空闲块
-    // 2. 基于数量的清理：限制每个池的空闲块数量
-    void cleanup_idle_blocks() {
-        size_t total_released = 0;
+#ifdef MEMORY_POOL_DEBUG
+    // 调试校验统一放在用户可见的分配/释放边界上：TLS缓存命中和全局路径
+    // 经过同一套检查，不改变任何内部路径的时序
+    static Memory_Pool_Debug_Trailer *debug_trailer(void *ptr, size_t class_size) {
+        return reinterpret_cast<Memory_Pool_Debug_Trailer *>(static_cast<char *>(ptr) +
+                                                             class_size);
+    }
+
+    // 采样闸门：每MEMORY_POOL_DEBUG_SAMPLE_RATE次释放做一次投毒（=1时全量）
+    static bool debug_sample() {
+        static thread_local uint32_t counter = 0;
+        return ++counter % MEMORY_POOL_DEBUG_SAMPLE_RATE == 0;
+    }
+
+    // 分配出口：块还带着毒值标记时先验毒（捕获释放后写——空闲期间用户区
+    // 被人改过），再盖上存活金丝雀并记录本次分配调用点
+    static void debug_on_allocate(void *ptr, size_t class_size, void *site) {
+        Memory_Pool_Debug_Trailer *trailer = debug_trailer(ptr, class_size);
+        if (trailer->canary == (MEMORY_POOL_POISON_MAGIC ^ reinterpret_cast<uintptr_t>(ptr))) {
+            const unsigned char *bytes = static_cast<const unsigned char *>(ptr);
+            for (size_t i = sizeof(void *); i < class_size; ++i) {
+                if (bytes[i] != MEMORY_POOL_POISON_BYTE) {
+                    memory_pool_debug_abort("use after free (poison overwritten while free)",
+                                            ptr, trailer->alloc_site);
+                }
+            }
+        }
+        trailer->canary = MEMORY_POOL_CANARY_MAGIC ^ reinterpret_cast<uintptr_t>(ptr);
+        trailer->alloc_site = site;
+    }
+
+    // 释放入口：尾巴已是毒值=双重释放，金丝雀被毁=越界写；采样命中时给
+    // 用户区投毒（保留块首的空闲链next字）并把尾巴换成毒值标记。
+    // alloc_site刻意保留——双重释放时报告的就是最近一次分配的调用点
+    static void debug_on_deallocate(void *ptr, size_t class_size) {
+        Memory_Pool_Debug_Trailer *trailer = debug_trailer(ptr, class_size);
+        uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+        if (trailer->canary == (MEMORY_POOL_POISON_MAGIC ^ addr)) {
+            memory_pool_debug_abort("double free", ptr, trailer->alloc_site);
+        }
+        if (trailer->canary != (MEMORY_POOL_CANARY_MAGIC ^ addr)) {
+            memory_pool_debug_abort("buffer overflow or invalid free (trailing canary mismatch)",
+                                    ptr, trailer->alloc_site);
+        }
+        if (debug_sample()) {
+            std::memset(static_cast<char *>(ptr) + sizeof(void *), MEMORY_POOL_POISON_BYTE,
+                        class_size - sizeof(void *));
+            trailer->canary = MEMORY_POOL_POISON_MAGIC ^ addr;
+        }
+    }
+#endif
 
-        // 1. 基于时间的清理：清理超过空闲超时时间的块
+    // 清理空闲内存块（增量式：每个池每轮最多处理budget_slabs个slab，
+    // 0表示用配置的cleanup_batch_slabs；释放的slab总数经released_out带出）
+    // 注意：固定大小池设计已经避免了碎片问题（相同大小的块可以完美复用）
+    // 返回是否还有积压（本轮预算用满，需要尽快再来一轮）
+    bool cleanup_idle_blocks(size_t budget_slabs = 0, size_t *released_out = nullptr) {
+        Memory_Pool_Reentry_Guard reentry; // 清理全程的内部分配不得路由回池
+        size_t budget = budget_slabs == 0 ? config_.cleanup_batch_slabs : budget_slabs;
+        size_t released = 0;
+        bool backlog = false;
+
+        // 0. 通告静默点并冲刷纪元回收器：上个周期退役的slab此时多半已度过
+        // 宽限期，物理页在新一轮退役之前归还（预算配额随之释放）。
+        // 这里的通告还保证了Block/Callback策略的重试线程自身不会卡住宽限期
+        reclaimer_->announce();
+        reclaimer_->flush();
+
+        // 1. 基于时间的清理：清理超过空闲超时时间的slab
         for (auto &pool : pools_) {
-            size_t released = pool->cleanup_idle_blocks_by_time(config_.idle_timeout);
-            total_released += released;
+            size_t n = pool->cleanup_idle_blocks_by_time(config_.idle_timeout, budget);
+            released += n;
+            backlog |= n == budget;
         }
 
         // 2. 基于数量的清理：每个池最多保留的空闲块数量
@@ -298,125 +1993,328 @@ class Memory_Pool {
         for (auto &pool : pools_) {
             size_t free_count = pool->get_free_block_count();
             if (free_count > MAX_FREE_BLOCKS_PER_POOL) {
-                size_t released = pool->cleanup_excess_blocks(MAX_FREE_BLOCKS_PER_POOL);
-                total_released += released;
+                size_t n = pool->cleanup_excess_blocks(MAX_FREE_BLOCKS_PER_POOL, budget);
+                released += n;
+                backlog |= n == budget;
             }
         }
 
-        // 3. 检查总内存使用是否超过限制
-        size_t current_total = stats_.total_allocated.load();
-        if (current_total > config_.max_total_memory) {
+        // 3. 检查总内存使用是否逼近预算（预算在分配时硬性执行，这里只是
+        // 提前腾空间，让突发流量不至于顶着上限反复失败/等待）
+        if (budget_->used() > config_.max_total_memory - config_.max_total_memory / 8) {
             // 如果超过限制，更激进的清理：每个池只保留 10 个空闲块
             for (auto &pool : pools_) {
-                size_t released = pool->cleanup_excess_blocks(10);
-                total_released += released;
+                size_t n = pool->cleanup_excess_blocks(10, budget);
+                released += n;
+                backlog |= n == budget;
             }
         }
 
-        // 更新当前空闲内存统计
-        size_t current_free = 0;
-        for (const auto &pool : pools_) {
-            size_t free_count = pool->get_free_block_count();
-            current_free += free_count * pool->get_block_size();
+        // 4. 后台预零化：限量把空闲块提前清零，让allocate_zeroed跳过memset
+        if (config_.pre_zero_batch_blocks > 0) {
+            for (auto &pool : pools_) {
+                backlog |= pool->pre_zero_free_blocks(config_.pre_zero_batch_blocks) ==
+                           config_.pre_zero_batch_blocks;
+            }
+        }
+
+        // 5. 灵薄链里还有slab在等宽限期：让清理线程用短间隔继续推进
+        backlog |= reclaimer_->has_pending();
+        if (released_out) {
+            *released_out = released;
+        }
+        return backlog;
+    }
+
+    // 执行一条异步命令并发布完成（在清理线程上运行；池关闭后也可能在
+    // 提交方线程上内联运行）
+    void execute_command(Pool_Async_Command *cmd) {
+        switch (cmd->kind_) {
+        case Pool_Async_Command::Kind::Snapshot:
+            cmd->snapshot = get_stats_snapshot();
+            break;
+        case Pool_Async_Command::Kind::Cleanup:
+            cleanup_idle_blocks(cmd->budget_slabs_, &cmd->released_slabs);
+            break;
+        }
+        cmd->complete();
+    }
+
+    // 整体摘下命令通道并逐条执行。摘除后命令按后进先出处理——命令之间
+    // 彼此独立，顺序无关紧要。next_必须在complete之前读出：完成标志一经
+    // 发布，提交方就可以销毁或复用句柄
+    void drain_commands() {
+        Pool_Async_Command *cmd = command_head_.exchange(nullptr, std::memory_order_acquire);
+        while (cmd) {
+            Pool_Async_Command *next = cmd->next_;
+            execute_command(cmd);
+            cmd = next;
         }
-        stats_.current_free.store(current_free);
+    }
 
-        // 固定大小池没有碎片问题，碎片计数设为0
-        stats_.fragment_count.store(0);
+    // 把命令压入通道并唤醒清理线程；池已关闭（或正在析构）时退化为
+    // 在提交方线程上同步执行，保证done()总会置位
+    void submit_command(Pool_Async_Command *cmd) {
+        cmd->done_.store(false, std::memory_order_relaxed);
+        if (shutdown_) {
+            execute_command(cmd);
+            return;
+        }
+        Pool_Async_Command *head = command_head_.load(std::memory_order_relaxed);
+        do {
+            cmd->next_ = head;
+        } while (!command_head_.compare_exchange_weak(head, cmd, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+        // 立即处理，不等下一个清理周期。空临界区把通知排到清理线程
+        // "谓词判定→入睡"的间隙之后，否则落在间隙里的唤醒会丢失，
+        // 命令要等到下个周期期限才被发现
+        { std::lock_guard<std::mutex> lock(cleanup_mutex_); }
+        cleanup_cv_.notify_one();
     }
 
-    // 清理线程函数
+    // 清理线程函数：有积压时用短间隔继续推进，否则等满一个清理周期；
+    // 条件变量让析构和命令提交都能立即唤醒它，而不是等睡眠自然结束。
+    // 周期清理按绝对期限推进：命令唤醒只处理命令，不顺带触发计划外的
+    // 清理轮（高频遥测轮询不改变池的回收节奏）
     void cleanup_thread_func() {
+        std::unique_lock<std::mutex> lock(cleanup_mutex_);
+        auto deadline = std::chrono::steady_clock::now() + config_.cleanup_interval;
         while (!shutdown_) {
-            std::this_thread::sleep_for(config_.cleanup_interval);
-            cleanup_idle_blocks();
+            cleanup_cv_.wait_until(lock, deadline, [this] {
+                return shutdown_.load() ||
+                       command_head_.load(std::memory_order_relaxed) != nullptr;
+            });
+            if (shutdown_) {
+                break;
+            }
+            drain_commands();
+            if (std::chrono::steady_clock::now() >= deadline) {
+                bool backlog = cleanup_idle_blocks();
+                deadline = std::chrono::steady_clock::now() +
+                           (backlog ? std::chrono::seconds(1) : config_.cleanup_interval);
+            }
         }
     }
 
-    // 初始化内存池
+    // 初始化内存池（池数组按[级别][分片]平铺：小块级别在前，中/大块级别紧随其后）
     void initialize_pools() {
-        for (size_t i = 0; i < 8; ++i) {
-            pools_.push_back(
-                std::make_unique<Fixed_Size_Pool>(config_.small_block_sizes[i], config_.alignment));
+        build_size_class_table();
+        numa_shard_count_ = config_.numa_shards == 0 ? detect_numa_node_count()
+                                                     : config_.numa_shards;
+        if (numa_shard_count_ > 1) {
+            build_cpu_shard_table();
+        }
+        budget_ = std::make_unique<Memory_Budget>(config_.max_total_memory);
+        slab_region_ = std::make_unique<Slab_Region>(config_.max_total_memory, budget_.get(),
+                                                     config_.slab_release_mode);
+        reclaimer_ = std::make_unique<Epoch_Reclaimer>(slab_region_.get());
+        for (size_t i = 0; i < SMALL_CLASS_COUNT + MEDIUM_CLASS_COUNT; ++i) {
+            for (size_t shard = 0; shard < numa_shard_count_; ++shard) {
+                pools_.push_back(std::make_unique<Fixed_Size_Pool>(
+                    class_size(i), slab_region_.get(), config_.alignment, reclaimer_.get()));
+            }
         }
     }
 
   public:
     // 构造函数
-    Memory_Pool(size_t max_total_memory = 1024 * 1024 * 1024, bool enable_tls = true,
-                size_t alignment = 8)
+    // numa_shards：每个级别的NUMA分片数（1=不分片，0=按检测到的节点数自动分片）
+    Basic_Memory_Pool(size_t max_total_memory = 1024 * 1024 * 1024, bool enable_tls = true,
+                      size_t alignment = 8, size_t numa_shards = 1)
         : shutdown_(false) {
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            config_.small_block_sizes[i] = Small_Classes::sizes[i];
+        }
         config_.max_total_memory = max_total_memory;
         config_.enable_tls = enable_tls;
         config_.alignment = alignment;
-        stats_.total_allocated = 0;
-        stats_.total_freed = 0;
-        stats_.current_used = 0;
-        stats_.current_free = 0;
-        stats_.alloc_count = 0;
-        stats_.free_count = 0;
-        stats_.fragment_count = 0;
+        config_.numa_shards = numa_shards;
 
         initialize_pools();
-        cleaner_thread_ = std::thread(&Memory_Pool::cleanup_thread_func, this);
+        cleaner_thread_ = std::thread(&Basic_Memory_Pool::cleanup_thread_func, this);
     }
 
     // 析构函数
-    ~Memory_Pool() {
+    ~Basic_Memory_Pool() {
         shutdown_ = true;
+        budget_->shutdown(); // 唤醒Block策略下阻塞等待配额的分配线程
+        // 空临界区保证唤醒不落进清理线程"谓词判定→入睡"的间隙（否则析构
+        // 要空等到下个周期期限才能join）
+        { std::lock_guard<std::mutex> lock(cleanup_mutex_); }
+        cleanup_cv_.notify_all();
         if (cleaner_thread_.joinable()) {
             cleaner_thread_.join();
         }
+        drain_commands(); // 清理线程退出时通道里可能还挂着命令，全部补齐完成
+
+        // 解除所有存活线程缓存与本池的归属关系：
+        // slab会随池一起释放，线程退出时看到owner为空就不再归还
+        {
+            std::lock_guard<std::mutex> lock(tls_registry_mutex());
+            for (Thread_Local_Cache *cache : tls_caches_) {
+                cache->owner = nullptr;
+            }
+            tls_caches_.clear();
+        }
+
         // 清理所有内存池
         pools_.clear();
     }
 
     // 禁止拷贝和移动
-    Memory_Pool(const Memory_Pool &) = delete;
-    Memory_Pool &operator=(const Memory_Pool &) = delete;
-    Memory_Pool(Memory_Pool &&) = delete;
-    Memory_Pool &operator=(Memory_Pool &&) = delete;
+    Basic_Memory_Pool(const Basic_Memory_Pool &) = delete;
+    Basic_Memory_Pool &operator=(const Basic_Memory_Pool &) = delete;
+    Basic_Memory_Pool(Basic_Memory_Pool &&) = delete;
+    Basic_Memory_Pool &operator=(Basic_Memory_Pool &&) = delete;
 
     // 分配内存（主要接口）
     void *allocate(size_t size) {
         if (shutdown_ || size == 0) {
             return nullptr;
         }
-
-        stats_.alloc_count++;
+        reclaimer_->announce(); // 静默点：入口处不持有任何池内指针
 
         // 找到对应的内存池索引
         int pool_index = find_pool_index(size);
 
         if (pool_index >= 0) {
-            // 小块内存：使用内存池
-            // 快速路径：优先从TLS缓存分配
-            void *ptr = allocate_from_tls(pool_index);
+            // 池化级别（≤64KB）：使用内存池
+            void *ptr = allocate_with_limit([&] { return allocate_from_class(pool_index); });
+#ifdef MEMORY_POOL_DEBUG
             if (ptr) {
-                stats_.total_allocated += config_.small_block_sizes[pool_index];
-                stats_.current_used += config_.small_block_sizes[pool_index];
-                return ptr;
+                debug_on_allocate(ptr, pool_at(pool_index, 0)->get_block_size(),
+                                  MEMORY_POOL_DEBUG_SITE());
             }
+#endif
+            return ptr;
+        }
+        // 超大块内存：直接使用系统malloc（带头部，便于释放时识别来源和大小）
+        return allocate_with_limit([&] { return allocate_large(size, config_.alignment); });
+    }
+
+    // 带调用点标签的分配：按tag聚合分配热点（快照的tags部分），
+    // 用于定位"哪个模块在吃内存"。标签按指针身份聚合，应传字符串字面量
+    // 或其他生命周期覆盖整个池的常量字符串。只有打了标签的调用付出
+    // 一次加锁计数的开销，常规allocate(size)不受影响。
+    void *allocate(size_t size, const char *tag) {
+        void *ptr = allocate(size);
+#ifndef MEMORY_POOL_DISABLE_STATS
+        if (ptr && tag) {
+            std::lock_guard<std::mutex> lock(tag_mutex_);
+            auto &entry = tag_stats_[tag];
+            entry.first++;
+            entry.second += size;
+        }
+#else
+        (void)tag;
+#endif
+        return ptr;
+    }
 
-            // 慢速路径：从全局池分配
-            ptr = pools_[pool_index]->allocate();
+    // calloc风格分配：返回内容全零的内存。新slab的块来自零页，只需擦掉空闲
+    // 链表字；清理线程还会在后台预零化空闲块，两种情况都完全跳过memset。
+    // 池内路径不经过TLS缓存：已知零状态只在全局空闲栈上维护，TLS里的热块几乎必脏。
+    void *allocate_zeroed(size_t size) {
+        if (shutdown_ || size == 0) {
+            return nullptr;
+        }
+        reclaimer_->announce();
+        int pool_index = find_pool_index(size);
+        if (pool_index >= 0) {
+#ifdef MEMORY_POOL_DEBUG
+            // 验毒必须发生在内容清零之前：调试构建绕开已知零优化，先走常规
+            // 分配（含验毒/盖金丝雀）再全量memset
+            void *ptr = allocate_with_limit([&] { return allocate_from_class(pool_index); });
             if (ptr) {
-                stats_.total_allocated += config_.small_block_sizes[pool_index];
-                stats_.current_used += config_.small_block_sizes[pool_index];
-                stats_.current_free -= config_.small_block_sizes[pool_index];
-                return ptr;
+                debug_on_allocate(ptr, pool_at(pool_index, 0)->get_block_size(),
+                                  MEMORY_POOL_DEBUG_SITE());
+                std::memset(ptr, 0, pool_at(pool_index, 0)->get_block_size());
             }
-            // 分配失败，返回nullptr
+            return ptr;
+#else
+            return allocate_with_limit([&]() -> void * {
+                void *ptr = pool_for(pool_index)->allocate_zeroed();
+                if (ptr) {
+                    record_alloc(pool_at(pool_index, 0)->get_block_size());
+                }
+                return ptr;
+            });
+#endif
+        }
+        return allocate_with_limit([&] { return allocate_large(size, config_.alignment, true); });
+    }
+
+    // 按指定对齐分配内存（alignment必须是2的幂）。池内块按级别的自然对齐布局，
+    // 对齐要求不满足时向更大的级别逐级提升（例如64字节对齐的16字节请求落在64B级别），
+    // 超出池化范围或对齐超过页大小时走带填充的malloc路径。
+    void *allocate_aligned(size_t size, size_t alignment) {
+        if (shutdown_ || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
             return nullptr;
-        } else {
-            // 大块内存：直接使用系统malloc
-            void *ptr = std::malloc(size);
+        }
+        if (alignment <= config_.alignment) {
+            return allocate(size);
+        }
+        reclaimer_->announce();
+
+        int pool_index = find_pool_index(size < alignment ? alignment : size);
+        size_t class_count = pools_.size() / numa_shard_count_;
+        while (pool_index >= 0 && static_cast<size_t>(pool_index) < class_count &&
+               pool_at(pool_index, 0)->get_natural_alignment() < alignment) {
+            pool_index++;
+        }
+        if (pool_index >= 0 && static_cast<size_t>(pool_index) < class_count) {
+            void *ptr = allocate_with_limit([&] { return allocate_from_class(pool_index); });
+#ifdef MEMORY_POOL_DEBUG
             if (ptr) {
-                stats_.total_allocated += size;
-                stats_.current_used += size;
+                debug_on_allocate(ptr, pool_at(pool_index, 0)->get_block_size(),
+                                  MEMORY_POOL_DEBUG_SITE());
+            }
+#endif
+            return ptr;
+        }
+        return allocate_with_limit([&] { return allocate_large(size, alignment); });
+    }
+
+    // realloc风格的调整大小：新大小仍落在当前块/级别的容量内时原地返回
+    // 同一个指针（零拷贝，增量增长的缓冲区大多走这条路），只有真正跨级别
+    // 时才分配新块并搬运。搬运量按旧块的实际容量计（池内块不记录请求大小）。
+    void *reallocate(void *ptr, size_t new_size) {
+        if (!ptr) {
+            return allocate(new_size);
+        }
+        if (new_size == 0) {
+            deallocate(ptr);
+            return nullptr;
+        }
+
+        reclaimer_->announce();
+        size_t old_capacity;
+        if (slab_region_->contains(ptr)) {
+            Slab_Header *slab = slab_region_->slab_at(ptr);
+            if (!slab) {
+                return nullptr; // 落在区域内但不属于任何存活slab的无效指针
             }
+            old_capacity = slab->pool->get_block_size();
+        } else {
+            size_t header_size =
+                (sizeof(Memory_Block_Header) + config_.alignment - 1) & ~(config_.alignment - 1);
+            old_capacity =
+                reinterpret_cast<Memory_Block_Header *>(static_cast<char *>(ptr) - header_size)
+                    ->size;
+        }
+
+        // 原地满足：当前块的容量本来就够（含原地收缩）
+        if (new_size <= old_capacity) {
             return ptr;
         }
+
+        void *new_ptr = allocate(new_size);
+        if (!new_ptr) {
+            return nullptr; // 失败时旧块保持有效（与realloc语义一致）
+        }
+        std::memcpy(new_ptr, ptr, old_capacity);
+        deallocate(ptr);
+        return new_ptr;
     }
 
     // 释放内存（主要接口）
@@ -424,98 +2322,440 @@ class Memory_Pool {
         if (!ptr) {
             return;
         }
+        reclaimer_->announce(); // 静默点：入口处不持有任何池内空闲块指针
 
-        stats_.free_count++;
+        // 池内的块：一次范围比较即可识别，元数据全部来自slab头部
+        if (slab_region_->contains(ptr)) {
+            Slab_Header *slab = slab_region_->slab_at(ptr);
+            if (!slab) {
+                return; // 落在区域内但不属于任何存活slab的无效指针
+            }
+            int pool_index = find_pool_index(slab->pool->get_block_size());
+            if (pool_index >= 0 && owns_pool(static_cast<size_t>(pool_index), slab->pool)) {
+#ifdef MEMORY_POOL_DEBUG
+                debug_on_deallocate(ptr, slab->pool->get_block_size());
+#endif
+                record_free(slab->pool->get_block_size());
+                // 尝试归还到TLS缓存（仅小块级别）
+                if (return_to_tls(pool_index, ptr)) {
+                    return;
+                }
+                // TLS缓存不可用，归还到块诞生的分片（保持NUMA本地性）
+                slab->pool->deallocate(ptr);
+            }
+            return;
+        }
 
-        // 从指针获取头部信息（需要计算偏移）
+        // 超大块内存：头部紧贴在用户指针之前，按其记录的原始地址free。
+        // 全局接管层的malloc兜底块从未计费也未记账，释放时同样跳过两者
         size_t header_size =
             (sizeof(Memory_Block_Header) + config_.alignment - 1) & ~(config_.alignment - 1);
         Memory_Block_Header *header =
             reinterpret_cast<Memory_Block_Header *>(static_cast<char *>(ptr) - header_size);
+        size_t size = header->size;
+        bool charged = header->charged;
+        std::free(header->raw);
+        if (charged) {
+            budget_->uncharge(size);
+            record_free(size);
+        }
+    }
 
-        // 检查是否是内存池分配的内存
-        if (header->pool_ptr != nullptr) {
-            // 找到对应的内存池索引
-            int pool_index = find_pool_index(header->block_size);
-            if (pool_index >= 0 && header->pool_ptr == pools_[pool_index].get()) {
-                // 小块内存：尝试归还到TLS缓存
-                if (return_to_tls(pool_index, ptr)) {
-                    // 成功归还到TLS，不更新全局统计
-                    return;
+    // 带大小的释放：调用方掌握块大小时（STL分配器的deallocate本来就带n），
+    // 按大小O(1)查表直达级别，省去slab头部读取和逐分片的归属校验，
+    // 命中TLS时整条释放路径只剩一次范围比较加一次查表。
+    // size必须等于分配时请求的大小；allocate_aligned可能把请求提升到
+    // 更大的级别，这类指针仍需走无大小的deallocate(ptr)。
+    void deallocate(void *ptr, size_t size) {
+        if (!ptr) {
+            return;
+        }
+        reclaimer_->announce();
+        int pool_index = find_pool_index(size);
+        if (pool_index >= 0 && slab_region_->contains(ptr)) {
+#ifdef MEMORY_POOL_DEBUG
+            debug_on_deallocate(ptr, pool_at(pool_index, 0)->get_block_size());
+#endif
+            record_free(pool_at(pool_index, 0)->get_block_size());
+            if (return_to_tls(pool_index, ptr)) {
+                return;
+            }
+            // TLS缓存不可用：归还到块诞生的分片（全局路径仍带位图校验）
+            Slab_Header *slab = slab_region_->slab_at(ptr);
+            if (slab) {
+                slab->pool->deallocate(ptr);
+            }
+            return;
+        }
+        // 超大块或未池化的大小：走通用路径（头部记录了malloc原始地址）
+        deallocate(ptr);
+    }
+
+    // 编译期根据对象大小计算池索引（-1表示回退到运行期的allocate路径，
+    // 可能命中中/大块级别或malloc直通），级别表直接取自模板几何
+    static constexpr int static_pool_index(size_t size) {
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            if (size <= Small_Classes::sizes[i]) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // 类型化分配接口：在编译期选定池索引并原地构造对象，
+    // 热路径上完全没有运行期的大小→级别查找
+    template <typename T, typename... Args> T *create(Args &&...args) {
+        constexpr int pool_index = static_pool_index(sizeof(T));
+        void *ptr = nullptr;
+
+        if constexpr (pool_index >= 0) {
+            if (shutdown_) {
+                return nullptr;
+            }
+            // 静默点：只用类型化接口的线程也要在这里注册/通告，
+            // 否则纪元回收器看不到它，宽限期对它的投机读形同虚设
+            reclaimer_->announce();
+            ptr = allocate_with_limit([&] {
+                void *p = allocate_from_tls(pool_index);
+                return p ? p : pool_for(pool_index)->allocate();
+            });
+            if (ptr) {
+#ifdef MEMORY_POOL_DEBUG
+                debug_on_allocate(ptr, pool_at(pool_index, 0)->get_block_size(),
+                                  MEMORY_POOL_DEBUG_SITE());
+#endif
+                record_alloc(pool_at(pool_index, 0)->get_block_size());
+            }
+        } else {
+            ptr = allocate(sizeof(T));
+        }
+
+        if (!ptr) {
+            return nullptr;
+        }
+
+        // 构造失败时把内存还给池再向上抛出
+        try {
+            return new (ptr) T(std::forward<Args>(args)...);
+        } catch (...) {
+            if constexpr (pool_index >= 0) {
+#ifdef MEMORY_POOL_DEBUG
+                debug_on_deallocate(ptr, pool_at(pool_index, 0)->get_block_size());
+#endif
+                if (!return_to_tls(pool_index, ptr)) {
+                    slab_region_->slab_at(ptr)->pool->deallocate(ptr);
                 }
+            } else {
+                deallocate(ptr);
+            }
+            throw;
+        }
+    }
 
-                // TLS缓存已满，归还到全局池
-                pools_[pool_index]->deallocate(ptr);
-                stats_.total_freed += config_.small_block_sizes[pool_index];
-                stats_.current_used -= config_.small_block_sizes[pool_index];
-                stats_.current_free += config_.small_block_sizes[pool_index];
+    // 类型化释放接口：析构对象并把内存还给编译期选定的池
+    template <typename T> void destroy(T *obj) {
+        if (!obj) {
+            return;
+        }
+        obj->~T();
+
+        constexpr int pool_index = static_pool_index(sizeof(T));
+        if constexpr (pool_index >= 0) {
+            reclaimer_->announce(); // 静默点：与create配对，纪元回收器要看得见本线程
+#ifdef MEMORY_POOL_DEBUG
+            debug_on_deallocate(obj, pool_at(pool_index, 0)->get_block_size());
+#endif
+            record_free(pool_at(pool_index, 0)->get_block_size());
+            if (return_to_tls(pool_index, obj)) {
                 return;
             }
+            // 归还到块诞生的分片（保持NUMA本地性）
+            slab_region_->slab_at(obj)->pool->deallocate(obj);
+        } else {
+            deallocate(obj);
         }
+    }
 
-        // 大块内存：使用系统free
-        size_t size = header->size;
-        std::free(header);
-        stats_.total_freed += size;
-        stats_.current_used -= size;
+    // 获取结构化统计快照（监控采集接口）。逐级别计数跨NUMA分片汇总；
+    // TLS命中统计在缓存容量调整/线程退出时批量并入，最多滞后一个观察窗口
+    // （tls_adapt_interval次分配）。快照是relaxed读的组合，不保证瞬时一致。
+    Pool_Stats_Snapshot get_stats_snapshot() const {
+        Pool_Stats_Snapshot snap;
+        snap.total_allocated_bytes = sum_allocated_bytes();
+        snap.total_freed_bytes = sum_freed_bytes();
+        for (const Stats_Shard &shard : stats_shards_) {
+            snap.alloc_count += shard.alloc_count.load(std::memory_order_relaxed);
+            snap.free_count += shard.free_count.load(std::memory_order_relaxed);
+        }
+
+        size_t class_count = pools_.size() / numa_shard_count_;
+        snap.classes.reserve(class_count);
+        for (size_t i = 0; i < class_count; ++i) {
+            Pool_Class_Stats cls;
+            cls.block_size = pool_at(i, 0)->get_block_size();
+            for (size_t shard = 0; shard < numa_shard_count_; ++shard) {
+                const Fixed_Size_Pool *pool = pool_at(i, shard);
+                cls.used_blocks += pool->get_current_used();
+                cls.free_blocks += pool->get_current_free();
+                cls.total_blocks += pool->get_total_allocated();
+                cls.global_alloc_count += pool->get_alloc_count();
+                cls.global_free_count += pool->get_free_count();
+                cls.slow_path_count += pool->get_slow_path_count();
+            }
+            if (i < SMALL_CLASS_COUNT) {
+                cls.tls_hit_count = tls_hit_counts_[i].load(std::memory_order_relaxed);
+                cls.tls_miss_count = tls_miss_counts_[i].load(std::memory_order_relaxed);
+            }
+            snap.classes.push_back(cls);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(tag_mutex_);
+            snap.tags.reserve(tag_stats_.size());
+            for (const auto &entry : tag_stats_) {
+                snap.tags.push_back({entry.first, entry.second.first, entry.second.second});
+            }
+        }
+        return snap;
     }
 
-    // 获取统计信息
+    // 获取统计信息（快照的文本格式化，便于日志输出）
     std::string get_stats() const {
+        Pool_Stats_Snapshot snap = get_stats_snapshot();
+        size_t current_used = snap.total_allocated_bytes > snap.total_freed_bytes
+                                  ? snap.total_allocated_bytes - snap.total_freed_bytes
+                                  : 0;
+        size_t current_free = 0;
+        for (const Pool_Class_Stats &cls : snap.classes) {
+            current_free += cls.free_blocks * cls.block_size;
+        }
+
         std::string result = "Memory Pool Stats:\n";
-        result += "  Total Allocated: " + std::to_string(stats_.total_allocated.load()) + " bytes\n";
-        result += "  Total Freed: " + std::to_string(stats_.total_freed.load()) + " bytes\n";
-        result += "  Current Used: " + std::to_string(stats_.current_used.load()) + " bytes\n";
-        result += "  Current Free: " + std::to_string(stats_.current_free.load()) + " bytes\n";
-        result += "  Alloc Count: " + std::to_string(stats_.alloc_count.load()) + "\n";
-        result += "  Free Count: " + std::to_string(stats_.free_count.load()) + "\n";
-        result += "  Fragment Count: " + std::to_string(stats_.fragment_count.load()) + "\n";
-        // 各池的统计信息
-        for (size_t i = 0; i < pools_.size(); ++i) {
+        result += "  Total Allocated: " + std::to_string(snap.total_allocated_bytes) + " bytes\n";
+        result += "  Total Freed: " + std::to_string(snap.total_freed_bytes) + " bytes\n";
+        result += "  Current Used: " + std::to_string(current_used) + " bytes\n";
+        result += "  Current Free: " + std::to_string(current_free) + " bytes\n";
+        result += "  Alloc Count: " + std::to_string(snap.alloc_count) + "\n";
+        result += "  Free Count: " + std::to_string(snap.free_count) + "\n";
+        result += "  Fragment Count: 0\n"; // 固定大小池设计没有碎片问题
+        // 各级别的统计信息（多NUMA分片时跨分片汇总）
+        for (size_t i = 0; i < snap.classes.size(); ++i) {
+            const Pool_Class_Stats &cls = snap.classes[i];
             result += "  Pool[" + std::to_string(i) + "] (Block Size: " +
-                      std::to_string(config_.small_block_sizes[i]) + "): ";
-            result += "Used=" + std::to_string(pools_[i]->get_current_used()) +
-                      ", Free=" + std::to_string(pools_[i]->get_current_free()) +
-                      ", Total=" + std::to_string(pools_[i]->get_total_allocated()) + "\n";
+                      std::to_string(cls.block_size) + "): ";
+            result += "Used=" + std::to_string(cls.used_blocks) +
+                      ", Free=" + std::to_string(cls.free_blocks) +
+                      ", Total=" + std::to_string(cls.total_blocks) +
+                      ", SlowPath=" + std::to_string(cls.slow_path_count) +
+                      ", TLS=" + std::to_string(cls.tls_hit_count) + "/" +
+                      std::to_string(cls.tls_hit_count + cls.tls_miss_count) + "\n";
+        }
+        for (const Pool_Tag_Stats &tag : snap.tags) {
+            result += "  Tag[" + std::string(tag.tag) + "]: Count=" +
+                      std::to_string(tag.alloc_count) +
+                      ", Bytes=" + std::to_string(tag.allocated_bytes) + "\n";
         }
 
         return result;
     }
 
+    // 设置预算耗尽时的处理策略（应在投入并发使用前设置，策略本身不加锁）
+    // Callback策略的回调在分配线程上执行，应只做甩负载（清缓存、丢请求等），
+    // 返回true表示已释放内存、值得重试
+    void set_limit_policy(Memory_Limit_Policy policy, std::function<bool()> callback = nullptr) {
+        config_.limit_policy = policy;
+        config_.limit_callback = std::move(callback);
+    }
+
+    // 设置清理线程归还空闲slab的方式（随时可调）
+    // Advise方式保持映射可写、物理页由操作系统惰性回收，日夜潮汐型负载
+    // 回暖时可免去大部分缺页和清零；Decommit方式立即归还、驻留内存即时下降
+    void set_slab_release_mode(Slab_Release_Mode mode) {
+        config_.slab_release_mode = mode;
+        slab_region_->set_release_mode(mode);
+    }
+
+    // 预热：把某个大小级别的空闲块预留到不低于block_count（按NUMA分片均摊）。
+    // slab切分时把next链写进每个块，数据页随之全部预缺页——预留之后的
+    // 首批分配直接走无锁快速路径，不吃slab慢速路径也不吃缺页中断。
+    // 返回该级别当前的空闲块总数（区域耗尽或预算不足时可能低于请求量）；
+    // 大小超出池化范围（>64KB走malloc直通）时无事可做，返回0
+    size_t reserve(size_t size, size_t block_count) {
+        int pool_index = find_pool_index(size);
+        if (pool_index < 0) {
+            return 0;
+        }
+        reclaimer_->announce();
+        size_t per_shard = (block_count + numa_shard_count_ - 1) / numa_shard_count_;
+        size_t total_free = 0;
+        for (size_t shard = 0; shard < numa_shard_count_; ++shard) {
+            total_free += pool_at(pool_index, shard)->reserve_blocks(per_shard);
+        }
+        return total_free;
+    }
+
+    // 按录制的统计快照预热：把每个级别的块数预留到快照水平。
+    // 典型用法：生产实例定期把get_stats_snapshot()落盘，滚动重启后的新实例
+    // 在接流量之前回放一份，冷启动的p99不再被slab慢速路径拖垮
+    void warm_up(const Pool_Stats_Snapshot &profile) {
+        for (const Pool_Class_Stats &cls : profile.classes) {
+            reserve(cls.block_size, cls.total_blocks);
+        }
+    }
+
+    // 预填当前线程的TLS缓存到各级别的当前容量（工作线程启动时调用一次，
+    // 首批分配直接命中TLS，不计入命中/未命中统计）；TLS关闭时为空操作
+    void warm_up_thread_cache() {
+        Thread_Local_Cache *cache = get_tls_cache();
+        if (!cache) {
+            return;
+        }
+        reclaimer_->announce();
+        for (size_t i = 0; i < SMALL_CLASS_COUNT; ++i) {
+            size_t count = cache->cache_count[i];
+            if (count >= cache->capacity[i]) {
+                continue;
+            }
+            void *chain = nullptr;
+            size_t got = pool_for(static_cast<int>(i))->allocate_chain(
+                &chain, cache->capacity[i] - count);
+            if (got == 0) {
+                continue;
+            }
+            void *tail = chain;
+            while (*static_cast<void **>(tail)) {
+                tail = *static_cast<void **>(tail);
+            }
+            *static_cast<void **>(tail) = cache->cache_head[i];
+            cache->cache_head[i] = chain;
+            cache->cache_count[i] = count + got;
+        }
+    }
+
+    // 当前计入预算的已提交字节数（slab提交+大块，随分配释放即时变化）
+    size_t get_committed_bytes() const { return budget_->used(); }
+
     // 手动触发清理
     void cleanup() { cleanup_idle_blocks(); }
 
+    // 异步统计快照：命令经无锁通道投给清理线程，快照在那边构建完后经句柄
+    // 的snapshot字段带回。提交方只做一次CAS入队加一次条件变量唤醒，不触碰
+    // 任何热路径锁——延迟敏感线程和监控轮询可以放心高频调用。
+    // 结果经done()轮询、wait()等待或on_complete回调获取
+    void request_stats_snapshot(Pool_Async_Command &cmd) {
+        cmd.kind_ = Pool_Async_Command::Kind::Snapshot;
+        submit_command(&cmd);
+    }
+
+    // 异步清理：让清理线程立刻执行一轮清理（不占用周期清理的计划），
+    // budget_slabs限定每个池本轮最多处理的slab数（0=用配置的
+    // cleanup_batch_slabs），释放的slab总数经句柄的released_slabs带回
+    void request_cleanup(Pool_Async_Command &cmd, size_t budget_slabs = 0) {
+        cmd.kind_ = Pool_Async_Command::Kind::Cleanup;
+        cmd.budget_slabs_ = budget_slabs;
+        submit_command(&cmd);
+    }
+
     // 获取配置
     PoolConfig get_config() const { return config_; }
 };
 
-// RAII 封装类：自动管理内存生命周期
-class Memory_Pool_RAII {
+// 默认几何的内存池（绝大多数使用方直接用这个名字即可）
+using Memory_Pool = Basic_Memory_Pool<>;
+
+// STL兼容的分配器适配器（满足C++17 Allocator要求）
+// 让标准容器的节点分配直接走内存池的TLS快速路径，例如：
+//   std::list<int, Pool_Allocator<int>> lst{Pool_Allocator<int>(pool)};
+//   std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+//                      Pool_Allocator<std::pair<const int, int>>> map{...};
+// 自定义几何的池通过第二个模板参数绑定：Pool_Allocator<int, Basic_Memory_Pool<...>>
+template <typename T, typename Pool = Memory_Pool> class Pool_Allocator {
+  private:
+    Pool *pool_; // 绑定的内存池（有状态分配器）
+
+    template <typename U, typename P> friend class Pool_Allocator;
+
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    // 容器赋值/交换时跟随传播，保证内存始终归还到分配它的池
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U> struct rebind {
+        using other = Pool_Allocator<U, Pool>;
+    };
+
+    explicit Pool_Allocator(Pool &pool) : pool_(&pool) {}
+
+    // rebind转换构造（容器内部用于节点类型）
+    template <typename U>
+    Pool_Allocator(const Pool_Allocator<U, Pool> &other) : pool_(other.pool_) {}
+
+    T *allocate(size_t n) {
+        void *ptr = pool_->allocate(n * sizeof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(ptr);
+    }
+
+    // 容器带着元素数来释放，转发给带大小的快速路径（免去slab头部读取）
+    void deallocate(T *ptr, size_t n) { pool_->deallocate(ptr, n * sizeof(T)); }
+
+    Pool *pool() const { return pool_; }
+};
+
+// 两个分配器相等当且仅当绑定同一个内存池（决定容器能否直接交换内存）
+template <typename T, typename U, typename Pool>
+bool operator==(const Pool_Allocator<T, Pool> &lhs, const Pool_Allocator<U, Pool> &rhs) {
+    return lhs.pool() == rhs.pool();
+}
+
+template <typename T, typename U, typename Pool>
+bool operator!=(const Pool_Allocator<T, Pool> &lhs, const Pool_Allocator<U, Pool> &rhs) {
+    return !(lhs == rhs);
+}
+
+// RAII 封装类：自动管理内存生命周期（任意几何的池都可用）
+template <typename Pool> class Basic_Memory_Pool_RAII {
   private:
-    Memory_Pool &pool_; // 内存池引用
-    void *memory_ptr_;  // 分配的内存指针
-    size_t size_;       // 分配的内存大小
+    Pool &pool_;       // 内存池引用
+    void *memory_ptr_; // 分配的内存指针
+    size_t size_;      // 分配的内存大小
 
   public:
     // 构造函数：从内存池分配内存
-    Memory_Pool_RAII(Memory_Pool &pool, size_t size)
+    Basic_Memory_Pool_RAII(Pool &pool, size_t size)
         : pool_(pool), memory_ptr_(nullptr), size_(size) {
         memory_ptr_ = pool_.allocate(size);
         if (!memory_ptr_) {
             throw std::runtime_error("Memory allocation failed");
         }
     }
+    // 构造函数：按指定对齐分配（例如缓存行/SIMD对齐的缓冲区）
+    Basic_Memory_Pool_RAII(Pool &pool, size_t size, size_t alignment)
+        : pool_(pool), memory_ptr_(nullptr), size_(size) {
+        memory_ptr_ = pool_.allocate_aligned(size, alignment);
+        if (!memory_ptr_) {
+            throw std::runtime_error("Memory allocation failed");
+        }
+    }
     // 析构函数：自动释放内存
-    ~Memory_Pool_RAII() {
+    ~Basic_Memory_Pool_RAII() {
         if (memory_ptr_) {
             pool_.deallocate(memory_ptr_);
         }
     }
     // 禁止拷贝和移动
-    Memory_Pool_RAII(const Memory_Pool_RAII &) = delete;
-    Memory_Pool_RAII &operator=(const Memory_Pool_RAII &) = delete;
-    Memory_Pool_RAII(Memory_Pool_RAII &&) = delete;
-    Memory_Pool_RAII &operator=(Memory_Pool_RAII &&) = delete;
+    Basic_Memory_Pool_RAII(const Basic_Memory_Pool_RAII &) = delete;
+    Basic_Memory_Pool_RAII &operator=(const Basic_Memory_Pool_RAII &) = delete;
+    Basic_Memory_Pool_RAII(Basic_Memory_Pool_RAII &&) = delete;
+    Basic_Memory_Pool_RAII &operator=(Basic_Memory_Pool_RAII &&) = delete;
     // 获取内存指针
     void *get() const { return memory_ptr_; }
     // 获取内存大小
@@ -523,3 +2763,136 @@ class Memory_Pool_RAII {
     // 检查是否有效
     bool is_valid() const { return memory_ptr_ != nullptr; }
 };
+
+// 默认几何池的RAII封装（保持既有名字可用）
+using Memory_Pool_RAII = Basic_Memory_Pool_RAII<Memory_Pool>;
+
+// 竞技场分配器：面向"同生共死"的请求级对象群。从内存池整块（64KB级别）
+// 取chunk，在chunk内碰撞指针（bump）分配，单个对象零记账；reset()把
+// 所有chunk按sized快速路径整块还给池，整体释放的代价是O(chunk数)而非
+// O(对象数)。超过单chunk容量的请求单独开专属chunk，不打断当前碰撞窗口。
+// 注意：reset()/析构不运行对象的析构函数，适合平凡析构的对象或由调用方
+// 自行析构的场景；竞技场非线程安全，按"每请求/每线程一个"的方式使用。
+template <typename Pool = Memory_Pool> class Basic_Memory_Arena {
+  private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024; // 普通chunk大小（最大的池化级别）
+
+    // chunk头部（置于chunk起始，链表串起本竞技场持有的所有chunk）
+    struct Chunk {
+        Chunk *next;
+        size_t size; // 整个chunk的字节数（sized释放时回传给池）
+    };
+
+    Pool &pool_;              // 底层内存池
+    Chunk *chunks_ = nullptr; // chunk单向链表（头插，新chunk在前）
+    char *cursor_ = nullptr;  // 当前chunk的碰撞指针
+    char *limit_ = nullptr;   // 当前chunk的末尾
+
+    static char *align_up(char *ptr, size_t alignment) {
+        return reinterpret_cast<char *>(
+            (reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    }
+
+    // 释放chunk链表直到stop（不含），返回stop（rewind和reset共用）
+    Chunk *release_chunks_until(Chunk *stop) {
+        while (chunks_ != stop) {
+            Chunk *next = chunks_->next;
+            pool_.deallocate(chunks_, chunks_->size);
+            chunks_ = next;
+        }
+        return stop;
+    }
+
+  public:
+    // 水位标记：记录某一时刻的分配状态，rewind()回滚到该时刻
+    struct Marker {
+        Chunk *chunks;
+        char *cursor;
+        char *limit;
+    };
+
+    explicit Basic_Memory_Arena(Pool &pool) : pool_(pool) {}
+
+    ~Basic_Memory_Arena() { reset(); }
+
+    // 禁止拷贝和移动（chunk链表与bump指针不宜共享）
+    Basic_Memory_Arena(const Basic_Memory_Arena &) = delete;
+    Basic_Memory_Arena &operator=(const Basic_Memory_Arena &) = delete;
+    Basic_Memory_Arena(Basic_Memory_Arena &&) = delete;
+    Basic_Memory_Arena &operator=(Basic_Memory_Arena &&) = delete;
+
+    // 碰撞分配：对齐当前指针、越界时取新chunk（alignment必须是2的幂）
+    void *allocate(size_t size, size_t alignment = 8) {
+        if (size == 0) {
+            return nullptr;
+        }
+        char *aligned = align_up(cursor_, alignment);
+        if (!cursor_ || aligned + size > limit_) {
+            // 超过单chunk容量的请求：专属chunk，当前碰撞窗口保持不动
+            if (size + alignment + sizeof(Chunk) > CHUNK_SIZE) {
+                size_t bytes = sizeof(Chunk) + alignment + size;
+                void *raw = pool_.allocate(bytes);
+                if (!raw) {
+                    return nullptr;
+                }
+                chunks_ = new (raw) Chunk{chunks_, bytes};
+                return align_up(static_cast<char *>(raw) + sizeof(Chunk), alignment);
+            }
+            void *raw = pool_.allocate(CHUNK_SIZE);
+            if (!raw) {
+                return nullptr;
+            }
+            chunks_ = new (raw) Chunk{chunks_, CHUNK_SIZE};
+            cursor_ = static_cast<char *>(raw) + sizeof(Chunk);
+            limit_ = static_cast<char *>(raw) + CHUNK_SIZE;
+            aligned = align_up(cursor_, alignment);
+        }
+        cursor_ = aligned + size;
+        return aligned;
+    }
+
+    // 类型化分配并原地构造（注意：reset()不会调用析构函数）
+    template <typename T, typename... Args> T *create(Args &&...args) {
+        void *ptr = allocate(sizeof(T), alignof(T));
+        return ptr ? new (ptr) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // 记录当前水位（配合rewind实现嵌套作用域）
+    Marker mark() const { return {chunks_, cursor_, limit_}; }
+
+    // 回滚到标记时刻：释放之后取的chunk并恢复碰撞指针
+    void rewind(const Marker &marker) {
+        release_chunks_until(marker.chunks);
+        cursor_ = marker.cursor;
+        limit_ = marker.limit;
+    }
+
+    // 整体释放：所有chunk按sized快速路径还给池，O(chunk数)
+    void reset() {
+        release_chunks_until(nullptr);
+        cursor_ = nullptr;
+        limit_ = nullptr;
+    }
+};
+
+// 竞技场作用域守卫：构造时记下水位，析构时回滚——长驻的竞技场
+// （例如每个工作线程一个）可以跨请求复用，每个请求套一层作用域即可。
+template <typename Arena> class Basic_Arena_Scope {
+  private:
+    Arena &arena_;                   // 被守卫的竞技场
+    typename Arena::Marker marker_;  // 进入作用域时的水位
+
+  public:
+    explicit Basic_Arena_Scope(Arena &arena) : arena_(arena), marker_(arena.mark()) {}
+    ~Basic_Arena_Scope() { arena_.rewind(marker_); }
+
+    // 禁止拷贝和移动（回滚只应发生一次）
+    Basic_Arena_Scope(const Basic_Arena_Scope &) = delete;
+    Basic_Arena_Scope &operator=(const Basic_Arena_Scope &) = delete;
+    Basic_Arena_Scope(Basic_Arena_Scope &&) = delete;
+    Basic_Arena_Scope &operator=(Basic_Arena_Scope &&) = delete;
+};
+
+// 默认几何池上的竞技场及其作用域守卫
+using Memory_Arena = Basic_Memory_Arena<>;
+using Memory_Arena_Scope = Basic_Arena_Scope<Memory_Arena>;
@@ -0,0 +1,196 @@
+#pragma once
+// 全局operator new/delete接管层（可选启用）
+//
+// 在且仅在一个翻译单元里include本头文件，进程内所有new/delete（含数组、
+// sized、对齐和nothrow变体）都会路由到一个进程级的Memory_Pool实例——
+// 第三方库和STL内部的分配无需改动任何调用点即可走TLS快速路径。
+// 重复include到多个翻译单元会在链接期报重复符号，这正是期望的防护。
+//
+// 实现要点：
+//   - 进程级实例在第一次分配时构造并刻意泄漏：静态析构阶段仍可能有
+//     delete进来，池必须活到进程结束（操作系统统一回收）。
+//   - 线程局部重入标记（memory_pool_reentry_flag）把池维护自身数据
+//     结构时产生的分配引向malloc兜底，兜底块采用与池的malloc直通路径
+//     完全相同的头部布局，因此释放路径无需区分来源。
+//   - 池分配失败（预算耗尽等）时同样退回malloc兜底，抛出式operator new
+//     只在malloc也失败时抛std::bad_alloc。
+//
+// 用法（新建一个.cpp或挑一个现有的）：
+//   #include "Memory_Pool_Global.h"
+// 需要定制实例参数时，在include之前定义：
+//   #define MEMORY_POOL_GLOBAL_MAX_MEMORY (4ull * 1024 * 1024 * 1024)
+
+#include "Memory_Pool.h"
+
+#include <new>
+
+#ifndef MEMORY_POOL_GLOBAL_MAX_MEMORY
+#define MEMORY_POOL_GLOBAL_MAX_MEMORY (1024ull * 1024 * 1024)
+#endif
+
+namespace memory_pool_global {
+
+// 进程级内存池单例：首次使用时构造，刻意不析构
+inline Memory_Pool &instance() {
+    static Memory_Pool *pool = new Memory_Pool(MEMORY_POOL_GLOBAL_MAX_MEMORY);
+    return *pool;
+}
+
+// 与Memory_Pool的malloc直通路径同款的头部偏移（默认对齐8字节）
+inline size_t header_size() {
+    return (sizeof(Memory_Block_Header) + 7) & ~size_t(7);
+}
+
+// malloc兜底分配：布局与池的大块路径一致，可被Memory_Pool::deallocate释放
+inline void *fallback_allocate(size_t size, size_t alignment) {
+    size_t total = header_size() + alignment + size;
+    void *raw = std::malloc(total);
+    if (!raw) {
+        return nullptr;
+    }
+    uintptr_t user = (reinterpret_cast<uintptr_t>(raw) + header_size() + alignment - 1) &
+                     ~(uintptr_t(alignment) - 1);
+    // charged=false：兜底块从未计入池预算，经池的deallocate释放时也不退配额
+    new (reinterpret_cast<char *>(user) - header_size()) Memory_Block_Header{size, raw, false};
+    return reinterpret_cast<void *>(user);
+}
+
+// malloc兜底释放（重入路径只会遇到兜底块，直接按头部释放，不触碰池）
+inline void fallback_free(void *ptr) {
+    Memory_Block_Header *header =
+        reinterpret_cast<Memory_Block_Header *>(static_cast<char *>(ptr) - header_size());
+    std::free(header->raw);
+}
+
+// 分配路由：重入中或池分配失败时走malloc兜底，彻底失败返回nullptr
+inline void *route_allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1; // new(0)必须返回可释放的独立指针
+    }
+    if (memory_pool_reentry_flag()) {
+        return fallback_allocate(size, alignment);
+    }
+    void *ptr;
+    {
+        Memory_Pool_Reentry_Guard reentry;
+        Memory_Pool &pool = instance();
+        ptr = alignment > 8 ? pool.allocate_aligned(size, alignment) : pool.allocate(size);
+    }
+    return ptr ? ptr : fallback_allocate(size, alignment);
+}
+
+// 释放路由：池统一识别池内块和带头部的malloc块（含兜底块）
+inline void route_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (memory_pool_reentry_flag()) {
+        fallback_free(ptr); // 池内部释放的只会是兜底块
+        return;
+    }
+    Memory_Pool_Reentry_Guard reentry;
+    instance().deallocate(ptr);
+}
+
+// 带大小的释放路由（sized delete，走按大小直达级别的快速路径）。
+// 普通new按默认new对齐分配，小于它的请求会被提升级别（例如5字节落在
+// 16B级别），这里把大小同样垫到默认new对齐，保证按大小查到的级别
+// 与分配时一致
+inline void route_free_sized(void *ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+    if (memory_pool_reentry_flag()) {
+        fallback_free(ptr);
+        return;
+    }
+    if (size < __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    }
+    Memory_Pool_Reentry_Guard reentry;
+    instance().deallocate(ptr, size);
+}
+
+} // namespace memory_pool_global
+
+// ---- 抛出式 new ----
+// 普通（无align_val_t的）new必须返回按__STDCPP_DEFAULT_NEW_ALIGNMENT__
+// （x86-64上为16）对齐的存储：超过64KB的大块走带填充的malloc路径，
+// 头部偏移只保证8字节对齐，按8路由会让含long double/SSE成员的大对象
+// 拿到错位存储
+void *operator new(std::size_t size) {
+    void *ptr = memory_pool_global::route_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    void *ptr = memory_pool_global::route_allocate(size, static_cast<size_t>(align));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+// ---- nothrow 式 new ----
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return memory_pool_global::route_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return memory_pool_global::route_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return memory_pool_global::route_allocate(size, static_cast<size_t>(align));
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return memory_pool_global::route_allocate(size, static_cast<size_t>(align));
+}
+
+// ---- delete（sized变体走按大小的快速路径；对齐变体可能发生过级别提升，
+// 统一走无大小路径让slab元数据裁决） ----
+void operator delete(void *ptr) noexcept { memory_pool_global::route_free(ptr); }
+void operator delete[](void *ptr) noexcept { memory_pool_global::route_free(ptr); }
+
+void operator delete(void *ptr, std::size_t size) noexcept {
+    memory_pool_global::route_free_sized(ptr, size);
+}
+void operator delete[](void *ptr, std::size_t size) noexcept {
+    memory_pool_global::route_free_sized(ptr, size);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept { memory_pool_global::route_free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    memory_pool_global::route_free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    memory_pool_global::route_free(ptr);
+}
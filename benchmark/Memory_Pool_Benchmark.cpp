@@ -0,0 +1,248 @@
+// 内存池基准测试套件
+//
+// 覆盖场景：
+//   1. 单线程各级别 allocate/free 配对（与 malloc/free 基线对比）
+//   2. 多线程同级别竞争
+//   3. 生产者/消费者跨线程释放（压 TLS 溢出路径）
+//   4. 冷启动预热（空池的首批分配）
+//   5. Memory_Pool_RAII 封装开销
+//
+// 每个场景输出 ops/sec 和 p99 延迟（每 64 次操作采样一次单次延迟）。
+//
+// 编译：g++ -std=c++17 -O2 -pthread benchmark/Memory_Pool_Benchmark.cpp -o memory_pool_benchmark
+// 运行：./memory_pool_benchmark
+
+#include "../Memory_Pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 单个场景的测量结果
+struct Bench_Result {
+    double ops_per_sec; // 吞吐量（每秒操作数）
+    double p99_ns;      // p99 单次操作延迟（纳秒）
+};
+
+// 从延迟采样中取 p99
+double percentile_99(std::vector<double> &samples) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t index = samples.size() * 99 / 100;
+    if (index >= samples.size()) {
+        index = samples.size() - 1;
+    }
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// 在当前线程上执行 iterations 次 op，每 64 次采样一次单次延迟
+template <typename Op>
+void run_op_loop(size_t iterations, Op &&op, std::vector<double> &samples) {
+    for (size_t i = 0; i < iterations; ++i) {
+        if ((i & 63) == 0) {
+            auto t0 = Clock::now();
+            op(i);
+            auto t1 = Clock::now();
+            samples.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        } else {
+            op(i);
+        }
+    }
+}
+
+// 单线程场景：执行 iterations 次 op 并统计
+template <typename Op> Bench_Result run_single(size_t iterations, Op &&op) {
+    std::vector<double> samples;
+    samples.reserve(iterations / 64 + 1);
+    auto start = Clock::now();
+    run_op_loop(iterations, op, samples);
+    auto stop = Clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    return {iterations / seconds, percentile_99(samples)};
+}
+
+// 多线程场景：thread_count 个线程各执行 iterations 次 op_factory(tid) 生成的操作
+template <typename Op_Factory>
+Bench_Result run_threads(size_t thread_count, size_t iterations, Op_Factory &&op_factory) {
+    std::vector<double> all_samples;
+    std::mutex samples_mutex;
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<double> samples;
+            samples.reserve(iterations / 64 + 1);
+            auto op = op_factory(t);
+            run_op_loop(iterations, op, samples);
+            std::lock_guard<std::mutex> lock(samples_mutex);
+            all_samples.insert(all_samples.end(), samples.begin(), samples.end());
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    auto stop = Clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    return {thread_count * iterations / seconds, percentile_99(all_samples)};
+}
+
+void print_result(const char *name, const Bench_Result &result) {
+    std::printf("  %-44s %12.0f ops/sec   p99 %8.0f ns\n", name, result.ops_per_sec,
+                result.p99_ns);
+}
+
+// 场景1：单线程 allocate/free 配对，逐级别与 malloc/free 对比
+void bench_single_thread_pairs(Memory_Pool &pool, size_t iterations) {
+    std::printf("[单线程 alloc/free 配对，%zu 次/级别]\n", iterations);
+    const size_t sizes[] = {8, 16, 32, 64, 128, 256, 512, 1024};
+    for (size_t size : sizes) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "Memory_Pool %zuB", size);
+        print_result(name, run_single(iterations, [&pool, size](size_t) {
+                         void *ptr = pool.allocate(size);
+                         pool.deallocate(ptr);
+                     }));
+        std::snprintf(name, sizeof(name), "malloc/free %zuB", size);
+        print_result(name, run_single(iterations, [size](size_t) {
+                         void *ptr = std::malloc(size);
+                         std::free(ptr);
+                     }));
+    }
+}
+
+// 场景2：N线程同级别竞争（64B，最容易打爆全局池的级别）
+void bench_contention(Memory_Pool &pool, size_t thread_count, size_t iterations) {
+    std::printf("[%zu 线程同级别竞争 64B，%zu 次/线程]\n", thread_count, iterations);
+    print_result("Memory_Pool 64B", run_threads(thread_count, iterations, [&pool](size_t) {
+                     return [&pool](size_t) {
+                         void *ptr = pool.allocate(64);
+                         pool.deallocate(ptr);
+                     };
+                 }));
+    print_result("malloc/free 64B", run_threads(thread_count, iterations, [](size_t) {
+                     return [](size_t) {
+                         void *ptr = std::malloc(64);
+                         std::free(ptr);
+                     };
+                 }));
+}
+
+// 场景3：生产者/消费者——分配和释放发生在不同线程，
+// 消费者的每次 deallocate 都会进入"别人分配的块"路径并周期性触发 TLS 溢出
+void bench_producer_consumer(Memory_Pool &pool, size_t total_blocks) {
+    std::printf("[生产者/消费者跨线程释放，%zu 块 64B]\n", total_blocks);
+
+    std::vector<void *> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool producer_done = false;
+
+    auto start = Clock::now();
+    std::thread producer([&] {
+        std::vector<void *> batch;
+        batch.reserve(256);
+        for (size_t i = 0; i < total_blocks; ++i) {
+            batch.push_back(pool.allocate(64));
+            if (batch.size() == 256 || i + 1 == total_blocks) {
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    queue.insert(queue.end(), batch.begin(), batch.end());
+                }
+                queue_cv.notify_one();
+                batch.clear();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            producer_done = true;
+        }
+        queue_cv.notify_one();
+    });
+
+    std::thread consumer([&] {
+        std::vector<void *> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [&] { return !queue.empty() || producer_done; });
+                batch.swap(queue);
+                if (batch.empty() && producer_done) {
+                    return;
+                }
+            }
+            for (void *ptr : batch) {
+                pool.deallocate(ptr);
+            }
+            batch.clear();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    auto stop = Clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    std::printf("  %-44s %12.0f 块/sec\n", "跨线程 alloc→free 流水", total_blocks / seconds);
+}
+
+// 场景4：冷启动预热——空池上的首批分配（全部走 slab 分配慢速路径）
+void bench_warm_up(size_t block_count) {
+    std::printf("[冷启动预热，首批 %zu 次 64B 分配]\n", block_count);
+    // 禁用TLS：冷启动测的是全局池/slab慢速路径本身
+    // 刻意不销毁：基准进程即将退出，析构会等待清理线程的睡眠周期
+    auto *pool = new Memory_Pool(1024 * 1024 * 1024, false);
+    std::vector<void *> blocks;
+    blocks.reserve(block_count);
+    auto result = run_single(block_count, [&](size_t) { blocks.push_back(pool->allocate(64)); });
+    print_result("Memory_Pool 冷启动 64B", result);
+    for (void *ptr : blocks) {
+        pool->deallocate(ptr);
+    }
+}
+
+// 场景5：RAII 封装与裸接口的开销对比
+void bench_raii(Memory_Pool &pool, size_t iterations) {
+    std::printf("[RAII 封装开销，%zu 次 128B]\n", iterations);
+    print_result("Memory_Pool_RAII 128B", run_single(iterations, [&pool](size_t) {
+                     Memory_Pool_RAII mem(pool, 128);
+                     (void)mem.get();
+                 }));
+    print_result("裸 allocate/deallocate 128B", run_single(iterations, [&pool](size_t) {
+                     void *ptr = pool.allocate(128);
+                     pool.deallocate(ptr);
+                 }));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    // 可选参数：每场景的迭代次数（默认100万）
+    size_t iterations = 1000000;
+    if (argc > 1) {
+        iterations = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    // 刻意不销毁：基准进程直接退出，析构会等待清理线程的睡眠周期
+    auto *pool = new Memory_Pool();
+
+    bench_single_thread_pairs(*pool, iterations);
+    bench_contention(*pool, 4, iterations);
+    bench_contention(*pool, 8, iterations / 2);
+    bench_producer_consumer(*pool, iterations);
+    bench_warm_up(iterations / 10);
+    bench_raii(*pool, iterations);
+
+    std::printf("\n%s\n", pool->get_stats().c_str());
+    return 0;
+}